@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Toroidal world stored as one bit per cell, 64 cells per 64-bit word.
+// Cell x of a row lives in bit (x % 64) of word (x / 64); rows are padded to
+// a whole number of words and the unused high bits of the last word are
+// always kept at zero.
+class BitGrid {
+private:
+    size_t m_width;
+    size_t m_height;
+    size_t m_wordsPerRow;
+    uint64_t m_lastWordMask;
+    std::vector<uint64_t> m_currentWords;
+    std::vector<uint64_t> m_nextWords;
+    uint32_t m_birth;      // neighbour-count masks, see Rule
+    uint32_t m_survival;
+
+    template <bool Conway>
+    void evolveRow(size_t y);
+
+public:
+    BitGrid(size_t width, size_t height);
+
+    void pack(const std::vector<int>& cells);
+    void unpack(std::vector<int>& cells) const;
+    // Copies rows that are already in this layout, stored as little-endian
+    // words (the payload of a bit-packed world file)
+    void loadWords(const unsigned char* rows);
+
+    // Any two-state rule with the 3x3 neighbourhood; B3/S23 by default
+    void setRule(uint32_t birth, uint32_t survival);
+    void evolve(int generations = 1);
+
+    void setCellState(size_t x, size_t y, int state);
+    // Sets the live cells among count bits of bits, starting at bit first,
+    // in row y from column x on, a word at a time. Cells past the width are
+    // dropped; dead bits leave the row as it is.
+    void setRowBits(size_t y, size_t x, const uint64_t* bits, size_t first, size_t count);
+    int getCellState(size_t x, size_t y) const;
+    size_t population() const;
+
+    size_t getWidth() const;
+    size_t getHeight() const;
+    size_t getWordsPerRow() const;
+    const std::vector<uint64_t>& getWords() const;
+};
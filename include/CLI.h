@@ -2,7 +2,13 @@
 #define CLI_H
 
 #include "GameOfLife.h"
+#include "Pattern.h"
+#include "OpenCLDevice.h"
+#include "CycleDetector.h"
+#include "CheckpointWriter.h"
 #include <string>
+#include <memory>
+#include <functional>
 
 class CLI {
 public:
@@ -15,21 +21,47 @@ private:
     GameOfLife* world;
     bool printAfterGeneration;
     int delayMs;
+    unsigned threadCount;
+    int snapshotInterval;
+    GameOfLife::KernelVariant kernelVariant;
+    int blockDepth;
+    GameOfLife::CellStorage cellStorage;
+    bool profileOpenCL;
+    std::string deviceSelector;
+    std::string multiDevices;
+    unsigned multiSubDevices;
+    Rule rule;
+    int maxCyclePeriod;   // 0 = no cycle detection
+    SimdIsa simdIsa;
+    PatternLibrary patterns;
+
+    // Periodic checkpoints during runs; autosave is null while disabled
+    std::unique_ptr<CheckpointWriter> autosave;
+    CheckpointSchedule autosaveSchedule;
+    size_t autosavesReported;
 
     void processCommand(const std::string& command);
     void printHelp() const;
     void createWorld();
-    void loadWorld();
-    void saveWorld();
+    void loadWorld(bool memoryMap);
+    void openWorld(const std::string& filename, bool memoryMap);
+    void saveWorld(const std::string& format);
+    void saveCheckpoint();
     void runEvolution(const std::string& mode, int generations);
+    void listDevices() const;
+    void printProfile(const GameOfLife::OpenCLProfile& profile) const;
+    void reportCycle(const CycleDetector& cycles) const;
+    // Runs evolve(n) for the given generations, split into chunks that end
+    // where an autosave is due; stops when evolve returns false
+    bool evolveInChunks(int generations, const std::function<bool(int)>& evolve);
+    void autosaveIfDue();
+    void reportAutosave();
     void setCellState();
     void getCellState();
     void setCellState1D();
     void getCellState1D();
-    void addGlider();
-    void addToad();
-    void addBeacon();
-    void addMethuselah();
+    // Stamps a built-in pattern or pattern file at coordinates read from stdin
+    void addPattern(const std::string& name, const std::string& label, long long offsetY = 0);
     bool parseCoordinates(const std::string& input, size_t& x, size_t& y);
 };
 
@@ -0,0 +1,107 @@
+#pragma once
+#include "WorldFile.h"
+#include "Rule.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// Writes world checkpoints on a background thread. The snapshot is double
+// buffered: submit() only copies the grid into the spare buffer and
+// returns, while the writer thread encodes and writes the previous one.
+// Each checkpoint goes to a temporary file that then replaces the target,
+// so the target always holds a complete world. The file stores the
+// generation and the rule, so a run resumes from it with its generation
+// counter, its rule and the dying cells of a Generations rule.
+class CheckpointWriter {
+public:
+    struct Stats {
+        size_t written;           // checkpoints completed
+        size_t replaced;          // snapshots dropped for a newer one before being written
+        uint64_t lastGeneration;  // generation of the last completed checkpoint
+        double writeSeconds;      // total time spent encoding and writing
+    };
+
+    // Text is not accepted: it has no header to keep the generation in
+    CheckpointWriter(const std::string& filename, WorldFileFormat format = WorldFileFormat::BinaryRLE);
+    // Writes the snapshot still pending, if any
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Only blocks while the grid is copied. A snapshot that is still waiting
+    // (the writer is busy with an older one) is replaced, not queued.
+    // Rules with more than two states need BinaryRLE and throw
+    // std::invalid_argument with Binary.
+    void submit(const std::vector<int>& cells, size_t width, size_t height, uint64_t generation,
+                const Rule& rule = Rule());
+    // Waits until every submitted snapshot is on disk; throws
+    // std::runtime_error if a write has failed since the last flush()
+    void flush();
+
+    Stats getStats() const;
+    const std::string& getFilename() const;
+    WorldFileFormat getFormat() const;
+
+private:
+    struct Snapshot {
+        std::vector<int> cells;
+        size_t width;
+        size_t height;
+        uint64_t generation;
+        int states;
+        std::string rule;
+    };
+
+    std::string m_filename;
+    WorldFileFormat m_format;
+    Snapshot m_pending;  // filled by submit()
+    Snapshot m_writing;  // owned by the writer thread while m_busy
+    bool m_hasPending;
+    bool m_busy;
+    bool m_stop;
+    std::string m_error;
+    Stats m_stats;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::thread m_thread;
+
+    void writerLoop();
+    void write(const Snapshot& snapshot);
+};
+
+// Decides when checkpoints are due: each time the world's generation
+// reaches a multiple of a generation interval (so a resumed run keeps the
+// cadence), or else once a time interval has passed since the last one.
+// Engines that evolve many generations per call are run in chunks of
+// generationsUntilDue(); for timed checkpoints the chunks are sized from
+// the generation rate measured by recordChunk().
+class CheckpointSchedule {
+public:
+    // Zero for both disables checkpoints; a generation interval wins
+    CheckpointSchedule(int everyGenerations = 0, double everySeconds = 0);
+
+    bool isEnabled() const;
+    int getEveryGenerations() const;
+    double getEverySeconds() const;
+
+    // Restarts the clock and the rate estimate, e.g. at the start of a run
+    void start();
+    // At most remaining; one generation while the rate is still unknown
+    int generationsUntilDue(uint64_t generation, int remaining) const;
+    void recordChunk(int generations, double seconds);
+    bool isDue(uint64_t generation) const;
+    void markSaved();
+
+private:
+    int m_everyGenerations;
+    double m_everySeconds;
+    std::chrono::steady_clock::time_point m_lastSave;
+    double m_rate;  // generations per second of the last chunk
+};
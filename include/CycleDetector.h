@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Hash of one cell: a splitmix64 mix of its index and state, zero for dead
+// cells. A grid hashes to the sum over its cells, so a cell change updates
+// the hash with one subtraction and one addition, and partial sums can be
+// added in any order (per thread, per work-group). The OpenCL kernels
+// compute the same function.
+inline uint64_t cellHash(uint64_t index, int state) {
+    if (state == 0)
+        return 0;
+    uint64_t z = ((index << 8) | static_cast<uint64_t>(state)) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t gridHash(const std::vector<int>& cells);
+
+// Finds the first repeated world state in a stream of grid hashes. Only the
+// hashes of the last maxPeriod generations are kept, so cycles of up to
+// maxPeriod generations are found (a still life has period 1) without
+// storing any grid.
+class CycleDetector {
+public:
+    explicit CycleDetector(int maxPeriod = 64);
+
+    void reset();
+    // Records the hash of the world at a generation, in increasing order.
+    // Returns true once the world has matched an earlier recorded generation.
+    bool record(uint64_t generation, uint64_t hash);
+
+    bool isPeriodic() const;
+    // First generation of the cycle and its length; generations that were
+    // not recorded (blocked OpenCL launches) can make the period a multiple
+    // of the true one
+    uint64_t getCycleStart() const;
+    uint64_t getPeriod() const;
+    int getMaxPeriod() const;
+
+private:
+    int m_maxPeriod;
+    std::deque<std::pair<uint64_t, uint64_t>> m_history;  // (generation, hash), oldest first
+    std::unordered_map<uint64_t, uint64_t> m_generationOf;
+    bool m_periodic;
+    uint64_t m_cycleStart;
+    uint64_t m_period;
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "WorldFile.h"
+
+// Message-passing transport between the processes of a distributed run. Every
+// rank listens on basePort + rank and the ranks connect to each other over
+// TCP, so a run can use several machines or several processes on one box.
+// Throws std::runtime_error on connection or transfer errors. POSIX only.
+class Communicator {
+public:
+    // A pending transfer: bytes sent to or received from a peer rank
+    struct Message {
+        int peer;
+        void* data;
+        size_t bytes;
+    };
+
+    // hosts[r % hosts.size()] is the address of rank r; empty = 127.0.0.1
+    Communicator(int rank, int size, const std::vector<std::string>& hosts, int basePort,
+                 double connectTimeoutSeconds = 30.0);
+    ~Communicator();
+
+    Communicator(const Communicator&) = delete;
+    Communicator& operator=(const Communicator&) = delete;
+
+    int rank() const;
+    int size() const;
+
+    // Performs all sends and receives concurrently and returns when every one
+    // has completed, so neighbours exchanging with each other cannot
+    // deadlock. Messages between the same two ranks are matched in order;
+    // messages to the own rank are copied.
+    void exchange(const std::vector<Message>& sends, const std::vector<Message>& receives);
+
+    uint64_t allReduceSum(uint64_t value);
+    void barrier();
+
+private:
+    int m_rank;
+    int m_size;
+    std::vector<int> m_sockets;  // by peer rank, -1 for the own rank
+};
+
+// Split of a width x height torus into px x py blocks, one per rank in
+// row-major order. Block sizes differ by at most one row or column.
+struct BlockDecomposition {
+    size_t width;
+    size_t height;
+    int px;
+    int py;
+
+    // Picks the process grid with the smallest halo per block
+    static BlockDecomposition choose(size_t width, size_t height, int ranks);
+
+    size_t columnBegin(int ix) const;
+    size_t rowBegin(int iy) const;
+    size_t blockWidth(int ix) const;
+    size_t blockHeight(int iy) const;
+};
+
+// The block of a distributed world owned by one rank, stored one byte per
+// cell with a ghost border as wide as the halo depth k. Halos are exchanged
+// once every k generations: after an exchange the ghost cells are valid k
+// cells deep, and each generation computes a region one cell narrower, so
+// fewer, larger messages replace k small ones at the cost of some redundant
+// computation near the block edges.
+class DistributedLife {
+public:
+    // Requires every block to be at least haloDepth cells on each side
+    DistributedLife(Communicator& comm, size_t width, size_t height, int haloDepth = 1);
+
+    // Cell states depend only on the seed and the cell's coordinates, so a
+    // world is identical for every number of ranks and equal to
+    // GameOfLife::randomize() with the same seed
+    void randomize(double aliveProbability, uint64_t seed);
+    // Bit-packed binary files are mapped and each rank reads only its block;
+    // other formats are loaded whole by every rank
+    void loadFromFile(const std::string& filename);
+
+    void evolve(int generations);
+
+    // Collective calls: every rank must make them
+    uint64_t population();
+    // Gathers the world on rank 0, which writes a single file
+    void saveGathered(const std::string& filename, WorldFileFormat format);
+    // Every rank writes its block to "<filename>.<rank>" as a binary world
+    // file, and rank 0 writes a text manifest listing the blocks to filename
+    void saveChunks(const std::string& filename);
+    // Rank 0 receives the whole world; other ranks receive an empty vector
+    std::vector<int> gather();
+
+    const BlockDecomposition& getDecomposition() const;
+    size_t getGeneration() const;
+    double getExchangeSeconds() const;
+    double getComputeSeconds() const;
+
+private:
+    Communicator& m_comm;
+    BlockDecomposition m_decomposition;
+    int m_halo;
+    int m_ix, m_iy;
+    size_t m_x0, m_y0;            // first owned column and row
+    size_t m_blockWidth, m_blockHeight;
+    size_t m_stride;              // m_blockWidth + 2 * m_halo
+    std::vector<uint8_t> m_current;
+    std::vector<uint8_t> m_next;
+    std::vector<uint8_t> m_columnsOut[2], m_columnsIn[2];
+    size_t m_generation;
+    double m_exchangeSeconds;
+    double m_computeSeconds;
+
+    int rankAt(int ix, int iy) const;
+    size_t localIndex(size_t x, size_t y) const;  // x, y include the ghost offset
+    void exchangeHalos();
+    void step(size_t margin);
+    std::vector<int> ownedCells() const;
+};
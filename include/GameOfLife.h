@@ -1,48 +1,280 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <memory>
+#include <functional>
+#include <cstdint>
 #include <CL/cl.h> 
+#include "WorldFile.h"
+#include "Rule.h"
+#include "SimdLife.h"
+
+class ThreadPool;
+class BitGrid;
+class HashLife;
+class MappedFile;
+class MultiDeviceLife;
+class Pattern;
+struct OpenCLDeviceInfo;
 
 class GameOfLife {
+public:
+    // OpenCL kernel used by evolveOpenCL()
+    enum class KernelVariant {
+        Naive,          // one cell per work-item, global memory reads
+        Tiled,          // local-memory tile with halo, several cells per work-item
+        TemporalBlocked // several generations per launch inside local memory
+    };
+
+    // Cell type of the OpenCL grid buffers; uploads and readbacks shrink
+    // with it
+    enum class CellStorage {
+        Int,       // one int per cell, as on the host
+        UChar,     // one byte per cell, works with every kernel variant
+        BitPacked  // 64 cells per word in BitGrid's layout, own kernel
+    };
+
+    // Work done by the last evolveSparse() call
+    struct SparseStats {
+        size_t tileCount = 0;         // tiles covering the world
+        size_t lastActiveTiles = 0;   // tiles recomputed in the final generation
+        size_t totalActiveTiles = 0;  // tiles recomputed over all generations
+        int generations = 0;
+    };
+
+    // Aggregated timings of one OpenCL phase, in milliseconds
+    struct PhaseStats {
+        size_t count = 0;
+        double totalMs = 0.0;
+        double meanMs = 0.0;
+        double p99Ms = 0.0;
+    };
+
+    // Collected while OpenCL profiling is enabled. Build time is measured on
+    // the host; the other phases come from command-queue profiling events.
+    struct OpenCLProfile {
+        PhaseStats build;
+        PhaseStats upload;
+        PhaseStats kernel;
+        PhaseStats readback;  // final readbacks and snapshots
+    };
+
+    // Last OpenCL initialization: context, queues, program and kernels
+    struct OpenCLStartup {
+        double initMs = 0.0;
+        std::string deviceName;
+        bool programFromCache = false;  // built from a cached binary
+        int initializations = 0;
+    };
+
 private:
     size_t m_width;
     size_t m_height;
-    std::vector<int> m_currentGrid;
-    std::vector<int> m_nextGrid;
+    mutable std::vector<int> m_currentGrid;
+    mutable std::vector<int> m_nextGrid;
+
+    // Bit-packed world file the initial generation is still read from; both
+    // grids stay empty until the first host access unpacks it
+    mutable std::unique_ptr<MappedFile> m_mappedWorld;
+    WorldFileHeader m_mappedHeader;
+
+    // Current generation while evolveBitPacked() is in use; the int grids
+    // are released meanwhile and unpacked again on the first host access
+    mutable std::unique_ptr<BitGrid> m_bitGrid;
+    // The same for evolveSimd(), one byte per cell
+    mutable std::unique_ptr<SimdLife> m_simdGrid;
+
+    Rule m_rule;
     
     cl_context context;
     cl_command_queue queue;
+    cl_command_queue transferQueue;
     cl_program program;
-    cl_kernel kernel;
-    cl_mem currentBuffer;
-    cl_mem nextBuffer;
+    // kernels[i] evolves gridBuffers[i] into gridBuffers[1 - i]
+    cl_kernel kernels[2];
+    cl_mem gridBuffers[2];
+    int currentBufferIndex;
+    // Grid hash reduction of hashed evolveOpenCL() runs: one partial sum per
+    // work-group and generation in hashBuffer
+    cl_kernel hashKernel;
+    cl_mem hashBuffer;
+    size_t hashGroups;
+    size_t hashGroupSize;
     cl_device_id device;
     bool openclInitialized;
+    size_t localWorkSize[2];
+    KernelVariant m_kernelVariant;
+    int m_blockDepth;
+    CellStorage m_cellStorage;
+    // Packed copy of the grid for UChar and BitPacked transfers
+    mutable std::vector<unsigned char> m_deviceStaging;
+    // Device selector given to setOpenCLDevice(); "auto" is resolved by a
+    // calibration run whose winner is kept in m_calibratedDevice
+    std::string m_deviceSelector;
+    std::string m_calibratedDevice;
+
+    // Which copy of the current generation is out of date: the host grid
+    // after OpenCL runs, the device buffer after host-side writes
+    mutable bool m_hostStale;
+    bool m_deviceStale;
+
+    // Queues are created with CL_QUEUE_PROFILING_ENABLE while set; samples
+    // are per-command durations in milliseconds
+    bool m_profiling;
+    OpenCLStartup m_startup;
+    std::vector<double> m_buildSamples;
+    std::vector<double> m_uploadSamples;
+    std::vector<double> m_kernelSamples;
+    mutable std::vector<double> m_readbackSamples;
+
+    // Tiles whose cells changed in the last evolveSparse() generation; only
+    // meaningful while m_nextGrid still holds the previous generation
+    std::vector<unsigned char> m_tileChanged;
+    bool m_sparseValid;
+    SparseStats m_sparseStats;
+
+    // Sum of cellHash() over the current grid while m_hashValid. Kept up to
+    // date by setCellState(), evolveScalar() and hashed OpenCL runs; any
+    // other change clears m_hashValid and getGridHash() recomputes it.
+    mutable uint64_t m_gridHash;
+    mutable bool m_hashValid;
+
+    // Instruction set of evolveSimd(); the best the CPU supports by default
+    SimdIsa m_simdIsa;
+
+    // Generations evolved by every engine, counted from the generation
+    // stored in the world file this world was loaded from
+    uint64_t m_generation;
+
+    std::unique_ptr<ThreadPool> m_threadPool;
+
+    // Kept between evolveHashLife() calls so its node cache and memoized
+    // results carry over; it holds the current grid while m_hashLifeValid
+    std::unique_ptr<HashLife> m_hashLife;
+    bool m_hashLifeValid;
+
+    // Kept between evolveMultiDevice() calls with the same device list
+    std::unique_ptr<MultiDeviceLife> m_multiDevice;
+    std::string m_multiDeviceConfig;
     
     int countNeighbors(size_t x, size_t y) const;
     size_t cellIndex(size_t x, size_t y) const; 
     
     bool initializeOpenCL();
+    bool createQueues();
+    std::string calibrateOpenCLDevice(const std::vector<OpenCLDeviceInfo>& devices);
+    bool createKernels();
+    bool createHashKernel();
     void cleanupOpenCL();
+    // Storage and kernel actually used on the device, which some rules
+    // override
+    CellStorage deviceStorage() const;
+    KernelVariant deviceVariant() const;
+    size_t deviceGridBytes() const;
+    bool createGridBuffers();
+    bool syncDeviceGrid();
+    void syncHostGrid() const;
+    void markHostModified();
 
 public:
+    // Receives periodic snapshots from evolveOpenCL(); generation counts from
+    // the start of that call
+    using SnapshotCallback = std::function<void(int generation, const std::vector<int>& grid)>;
+    // Receives the grid hash (see cellHash()) computed on the device after
+    // each generation of evolveOpenCL(), in order; blocked kernels report
+    // once per launch. Returning true ends the run early; hashes are read
+    // back in batches, so generations already computed are still reported.
+    using HashCallback = std::function<bool(int generation, uint64_t hash)>;
+
     GameOfLife(size_t width, size_t height);
-    GameOfLife(const std::string &filename);
+    // With memoryMap set, bit-packed binary files are mapped instead of read
+    GameOfLife(const std::string &filename, bool memoryMap = false);
     ~GameOfLife();
     
     void evolveScalar();
-    bool evolveOpenCL(int generations = 1); 
+    void evolveBitPacked(int generations = 1);
+    // Byte-per-cell SIMD engine (see SimdLife); rules that are not
+    // life-like run on evolveScalar()
+    void evolveSimd(int generations = 1);
+    void evolveThreaded(int generations = 1, unsigned threadCount = 0);
+    void evolveSparse(int generations = 1);
+    const SparseStats& getSparseStats() const;
+    // Jumps through generations in powers of two; the quadtree cache is
+    // trimmed back once it grows past maxNodes nodes
+    void evolveHashLife(uint64_t generations, size_t maxNodes = size_t(1) << 22);
+    bool evolveOpenCL(int generations = 1, int snapshotInterval = 0,
+                      const SnapshotCallback& onSnapshot = SnapshotCallback(),
+                      const HashCallback& onHash = HashCallback());
+    // Splits the world into strips over several OpenCL devices; devices is a
+    // comma-separated list of device selectors (empty = all devices) and
+    // subDevices > 1 partitions each device, see MultiDeviceLife. With zero
+    // generations only the devices are initialized.
+    bool evolveMultiDevice(int generations, const std::string& devices = std::string(), unsigned subDevices = 0);
+    // One line per strip of the last evolveMultiDevice() run
+    std::vector<std::string> getMultiDeviceStrips() const;
+    
+    // Selects the device used by the next OpenCL initialization: an index
+    // into listOpenCLDevices(), a device or platform name substring, or
+    // "auto" for the fastest device on this world's size. Empty uses
+    // $GOL_OPENCL_DEVICE, then the first GPU, then the first device.
+    void setOpenCLDevice(const std::string& selector);
+    const std::string& getOpenCLDevice() const;
+
+    // Applies to every engine. Cells in states the new rule lacks die.
+    // bitpacked and hashlife run life-like rules only (hashlife without B0)
+    // and fall back to the scalar engine for the others; on the OpenCL path
+    // multi-state rules use uchar instead of bit-packed storage and Larger
+    // than Life rules always use their own naive kernel.
+    void setRule(const Rule& rule);
+    const Rule& getRule() const;
+    // An instruction set the CPU lacks is replaced by the best one it has
+    void setSimdIsa(SimdIsa isa);
+    SimdIsa getSimdIsa() const;
+
+    // BitPacked ignores the kernel variant
+    void setCellStorage(CellStorage storage);
+    CellStorage getCellStorage() const;
+    void setKernelVariant(KernelVariant variant);
+    KernelVariant getKernelVariant() const;
+    void setTemporalBlockDepth(int depth);
+    int getTemporalBlockDepth() const;
+    // Profiling adds an event per enqueued command; samples accumulate
+    // across evolveOpenCL() calls until resetOpenCLProfile()
+    void setOpenCLProfiling(bool enabled);
+    bool getOpenCLProfiling() const;
+    const OpenCLStartup& getOpenCLStartup() const;
+    OpenCLProfile getOpenCLProfile() const;
+    void resetOpenCLProfile();
     
     void print() const;
-    void randomize(double aliveProbability = 0.3);
+    // Counter-based random fill (see RandomFill.h): the same seed and size
+    // give the same world for any thread count, and randomizeOpenCL() gives
+    // it too. The host fill runs on the evolveThreaded() pool.
+    void randomize(double aliveProbability = 0.3, uint64_t seed = 1);
+    // Fills the device grid without an upload; the host copy is read back
+    // when it is next needed. False if OpenCL could not be initialized.
+    bool randomizeOpenCL(double aliveProbability = 0.3, uint64_t seed = 1);
     
     void setCellState(size_t x, size_t y, int state);
     int getCellState(size_t x, size_t y) const;
     void setCellState1D(size_t idx, int state);
+    // Sets the pattern's live cells with (x, y) as its top-left corner; cells
+    // that fall outside the world are dropped, as with setCellState()
+    void stampPattern(const Pattern& pattern, long long x, long long y);
     int getCellState1D(size_t idx) const;
-    void saveToFile(const std::string &filename);
+    void saveToFile(const std::string &filename, WorldFileFormat format = WorldFileFormat::Text);
+    // Bit-packed binary save written through a mapping of the output file;
+    // throws std::invalid_argument for rules with more than two states
+    void saveCheckpoint(const std::string &filename);
     
     size_t getWidth() const;
     size_t getHeight() const;
     const std::vector<int>& getCurrentGrid() const;
+    // Order-independent hash of the current grid, for cycle detection
+    // without grid copies; see CycleDetector
+    uint64_t getGridHash() const;
+    // Saved in binary world files and checkpoints and restored on load, so a
+    // resumed run keeps counting where it stopped
+    uint64_t getGeneration() const;
+    void setGeneration(uint64_t generation);
 };
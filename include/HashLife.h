@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+// HashLife engine for toroidal worlds. The world is a hash-consed quadtree
+// whose nodes memoize their own future, so a single step can advance
+// 2^k generations. A torus behaves like an infinitely repeating plane:
+// square worlds with a power-of-two side stay in quadtree form for the whole
+// run and jump up to 2^60 generations at once. Other sizes are rebuilt from
+// the flat grid before every jump, which costs time proportional to the
+// area; how long that jump may be depends on the node budget and on how
+// many factors of two the sides have (see maxFlatJump()).
+//
+// The node cache, memoized results included, survives load(), so an
+// engine kept across runs reuses everything it has computed. It is bounded
+// by maxNodes: a jump that would grow it further is abandoned and split.
+class HashLife {
+public:
+    typedef uint32_t NodeId;
+
+    // birth and survival are neighbour-count masks (see Rule); rules with
+    // birth on zero neighbours are not supported
+    explicit HashLife(size_t maxNodes = size_t(1) << 22,
+                      uint32_t birth = 1u << 3, uint32_t survival = (1u << 2) | (1u << 3));
+
+    void load(const std::vector<int>& cells, size_t width, size_t height);
+    void store(std::vector<int>& cells) const;
+    void advance(uint64_t generations);
+
+    void setMaxNodes(size_t maxNodes);
+    size_t getMaxNodes() const;
+    bool hasRule(uint32_t birth, uint32_t survival) const;
+
+    uint64_t population() const;
+    size_t nodeCount() const;
+    uint64_t getGeneration() const;
+
+private:
+    struct Node {
+        NodeId nw, ne, sw, se;
+        NodeId result;       // centre after 2^resultStep generations
+        int resultStep;      // -1 while nothing is memoized
+        unsigned level;      // node covers 2^level x 2^level cells
+        uint64_t population;
+    };
+
+    struct Key {
+        NodeId nw, ne, sw, se;
+        bool operator==(const Key& other) const {
+            return nw == other.nw && ne == other.ne && sw == other.sw && se == other.se;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t h = key.nw;
+            h = h * 0x9E3779B97F4A7C15ull + key.ne;
+            h = h * 0x9E3779B97F4A7C15ull + key.sw;
+            h = h * 0x9E3779B97F4A7C15ull + key.se;
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    // Offset of a square modulo the world size, for the periodic build
+    struct BuildKey {
+        unsigned level;
+        uint64_t x, y;
+        bool operator==(const BuildKey& other) const {
+            return level == other.level && x == other.x && y == other.y;
+        }
+    };
+
+    struct BuildKeyHash {
+        size_t operator()(const BuildKey& key) const {
+            uint64_t h = key.level;
+            h = h * 0x9E3779B97F4A7C15ull + key.x;
+            h = h * 0x9E3779B97F4A7C15ull + key.y;
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    std::vector<Node> m_nodes;
+    std::unordered_map<Key, NodeId, KeyHash> m_table;
+    std::vector<NodeId> m_emptyNodes;
+    size_t m_maxNodes;
+    size_t m_nodeLimit;   // node count that abandons the current jump
+    bool m_overBudget;    // set by join() once m_nodeLimit is passed
+    uint32_t m_birth;
+    uint32_t m_survival;
+
+    size_t m_width;
+    size_t m_height;
+    unsigned m_torusLevel;       // side 2^m_torusLevel, or 0 when not quadtree-resident
+    NodeId m_torus;
+    std::vector<int> m_cells;    // flat world for non power-of-two sizes
+    uint64_t m_generation;
+    std::vector<char> m_buildMemoLevels;
+    std::unordered_map<BuildKey, NodeId, BuildKeyHash> m_buildMemo;
+
+    void reset();
+    NodeId join(NodeId nw, NodeId ne, NodeId sw, NodeId se);
+    NodeId empty(unsigned level);
+    NodeId centre(NodeId n);
+    NodeId baseStep(NodeId n);
+    NodeId step(NodeId n, unsigned k);
+    NodeId build(const std::vector<int>& cells, unsigned level, int64_t x0, int64_t y0);
+    void flatten(NodeId n, int64_t x0, int64_t y0, std::vector<int>& cells) const;
+    uint64_t flatBuildNodes(unsigned rootLevel) const;
+    unsigned maxFlatJump() const;
+    bool jumpFlat(unsigned k);
+    bool jumpTorus(unsigned k);
+    void collectGarbage();
+};
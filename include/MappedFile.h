@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Whole-file memory mapping: read-only for existing files, read-write for
+// newly created ones. Uses mmap on POSIX systems and file mappings on
+// Windows. Throws std::runtime_error when a file cannot be opened or mapped.
+class MappedFile {
+private:
+    unsigned char* m_data;
+    size_t m_size;
+    bool m_writable;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_fd;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    void openRead(const std::string& filename);
+    // Creates or truncates the file, sizes it and maps it writable
+    void create(const std::string& filename, size_t size);
+    // Writes dirty pages of a writable mapping back to the file
+    void flush();
+    void close();
+
+    bool isOpen() const;
+    const unsigned char* data() const;
+    unsigned char* data();
+    size_t size() const;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <CL/cl.h>
+#include "Rule.h"
+
+// Multi-device OpenCL engine. The toroidal world is split into horizontal
+// strips, one per device or sub-device, with strip heights proportional to
+// compute units. Each strip reads its neighbours' edge rows from a separate
+// halo buffer. Every generation the two edge rows are computed first and
+// read back on a transfer queue while the interior rows are computed, and
+// they are written into the neighbours' halo buffers before the next
+// generation. Each strip has its own context and halos pass through the
+// host, so strips can run on devices of different platforms.
+class MultiDeviceLife {
+public:
+    // Rules with the 3x3 neighbourhood only; the kernel is built for the rule
+    MultiDeviceLife(size_t width, size_t height, const Rule& rule = Rule());
+    ~MultiDeviceLife();
+
+    MultiDeviceLife(const MultiDeviceLife&) = delete;
+    MultiDeviceLife& operator=(const MultiDeviceLife&) = delete;
+
+    // devices is a comma-separated list of findOpenCLDevice() selectors;
+    // empty uses every device. With subDevices > 1 each device is split
+    // into that many sub-devices with clCreateSubDevices; devices that
+    // cannot be partitioned are used whole. Returns false on failure.
+    bool initialize(const std::string& devices, unsigned subDevices = 0);
+
+    bool upload(const std::vector<int>& cells);
+    bool evolve(int generations);
+    bool download(std::vector<int>& cells);
+
+    size_t stripCount() const;
+    // "name: rows a-b" per strip, for reports
+    std::vector<std::string> describeStrips() const;
+
+private:
+    struct Strip {
+        cl_device_id device = nullptr;
+        bool subDevice = false;
+        std::string name;
+        cl_uint computeUnits = 1;
+        size_t rowBegin = 0;
+        size_t rows = 0;
+        cl_context context = nullptr;
+        cl_command_queue computeQueue = nullptr;
+        cl_command_queue transferQueue = nullptr;
+        cl_program program = nullptr;
+        cl_kernel kernels[2] = { nullptr, nullptr };  // kernels[i] evolves cells[i] into cells[1 - i]
+        cl_mem cells[2] = { nullptr, nullptr };
+        cl_mem halos[2] = { nullptr, nullptr };       // row above, row below; halos[i] goes with cells[i]
+        cl_mem edges = nullptr;                       // new first and last row
+        cl_event haloWritten[2] = { nullptr, nullptr };
+        std::vector<int> hostEdges[2];                // by generation parity
+    };
+
+    size_t m_width;
+    size_t m_height;
+    Rule m_rule;
+    std::vector<Strip> m_strips;
+    int m_current;  // index of the cell and halo buffers holding the current generation
+
+    bool createStrip(Strip& strip);
+    bool enqueueStripRows(Strip& strip, int rowBegin, size_t rowCount, cl_event* done);
+    void releaseEvents(Strip& strip);
+    void cleanup();
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <CL/cl.h>
+
+// One OpenCL device of any type on any platform. index is the position in
+// listOpenCLDevices(), which stays stable while the installed drivers do.
+struct OpenCLDeviceInfo {
+    size_t index;
+    cl_platform_id platform;
+    cl_device_id id;
+    std::string platformName;
+    std::string name;
+    cl_device_type type;
+    cl_uint computeUnits;
+    cl_ulong localMemory;
+    size_t maxWorkGroupSize;
+};
+
+std::vector<OpenCLDeviceInfo> listOpenCLDevices();
+
+// "GPU", "CPU", "accelerator" or "other"
+const char* openclDeviceTypeName(cl_device_type type);
+
+// Resolves a list index or a case-insensitive substring of the device or
+// platform name. An empty selector picks the first GPU, otherwise the first
+// device. Returns false if nothing matches.
+bool findOpenCLDevice(const std::vector<OpenCLDeviceInfo>& devices, const std::string& selector, size_t& index);
+
+// String-valued clGetDeviceInfo query; empty on failure
+std::string openclDeviceString(cl_device_id device, cl_device_info param);
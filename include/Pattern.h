@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+// Rectangular pattern stored one bit per cell in BitGrid's layout: cell x of
+// a row lives in bit (x % 64) of word (x / 64), rows padded to whole words.
+class Pattern {
+private:
+    size_t m_width;
+    size_t m_height;
+    size_t m_wordsPerRow;
+    std::vector<uint64_t> m_words;
+    std::string m_name;
+    std::string m_rule;
+
+public:
+    Pattern();
+    Pattern(size_t width, size_t height);
+
+    // Both parsers throw std::runtime_error on malformed input and on
+    // bounding boxes of more than 2^32 cells
+    static Pattern parseRLE(const std::string& text);
+    static Pattern parseLife106(const std::string& text);
+    // Picks the parser from the "#Life 1.06" header, defaulting to RLE
+    static Pattern parse(const std::string& text);
+    static Pattern loadFile(const std::string& filename);
+
+    void setCell(size_t x, size_t y);
+    // Sets cells x .. x + length - 1 of row y
+    void setRun(size_t x, size_t y, size_t length);
+    bool getCell(size_t x, size_t y) const;
+    size_t population() const;
+
+    size_t getWidth() const;
+    size_t getHeight() const;
+    size_t getWordsPerRow() const;
+    const uint64_t* row(size_t y) const;
+    void setName(const std::string& name);
+    const std::string& getName() const;
+    const std::string& getRule() const;
+};
+
+// Parsed patterns by name. Built-in patterns are available by name; any
+// other name is treated as a file path, parsed once and then served from
+// the cache.
+class PatternLibrary {
+private:
+    std::unordered_map<std::string, Pattern> m_patterns;
+    std::vector<std::string> m_builtinNames;
+
+public:
+    PatternLibrary();
+
+    const Pattern& get(const std::string& nameOrPath);
+    const std::vector<std::string>& getBuiltinNames() const;
+};
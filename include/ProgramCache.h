@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <CL/cl.h>
+
+// On-disk cache of built OpenCL program binaries. An entry is keyed by the
+// device name, driver version, kernel source and build options, so a new
+// driver or a kernel change misses the cache instead of loading a stale
+// binary. Entries live in $GOL_KERNEL_CACHE_DIR, or "gol_kernel_cache" in
+// the working directory; setting the variable to "off" disables the cache.
+// Cache failures are never fatal: callers fall back to a source build.
+struct ProgramCacheKey {
+    std::string description;  // device, driver and source hash, stored in the entry
+    std::string filename;     // empty when the cache is disabled
+};
+
+// Overrides the environment for later keys; an empty string restores it
+void setProgramCacheDirectory(const std::string& directory);
+
+ProgramCacheKey makeProgramCacheKey(cl_device_id device, const std::string& source, const std::string& options);
+
+// Returns false if there is no entry or it was written for another key
+bool loadProgramBinary(const ProgramCacheKey& key, std::vector<unsigned char>& binary);
+
+// Stores the binary of a program built for a single device
+void storeProgramBinary(const ProgramCacheKey& key, cl_program program);
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2,
+// 3"): ten rounds of multiplies and key additions turn a 128-bit counter
+// and a 64-bit key into four random 32-bit words. Each output depends only
+// on its counter and key, so cells can be generated in any order on any
+// number of threads. The OpenCL kernels compute the same function.
+struct PhiloxBlock {
+    uint32_t words[4];
+};
+
+inline PhiloxBlock philox4x32(uint64_t counter, uint64_t stream, uint64_t key) {
+    uint32_t c0 = static_cast<uint32_t>(counter);
+    uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+    uint32_t c2 = static_cast<uint32_t>(stream);
+    uint32_t c3 = static_cast<uint32_t>(stream >> 32);
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = uint64_t(0xD2511F53u) * c0;
+        uint64_t p1 = uint64_t(0xCD9E8D57u) * c2;
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<uint32_t>(p1);
+        c3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    return PhiloxBlock{ { c0, c1, c2, c3 } };
+}
+
+// A cell is alive if its 32-bit word is below this; 2^32 makes every cell
+// alive
+inline uint64_t aliveThreshold(double aliveProbability) {
+    if (aliveProbability <= 0.0)
+        return 0;
+    if (aliveProbability >= 1.0)
+        return uint64_t(1) << 32;
+    return static_cast<uint64_t>(aliveProbability * 4294967296.0);
+}
+
+// Cell i of a random world is word i % 4 of the block for counter i / 4.
+// stream tells apart worlds that share a seed (see WorldBatch). Fills
+// count cells starting at cell index first, so any range of a world can be
+// filled on its own.
+template <class Cell>
+void fillRandomCells(Cell* cells, uint64_t first, size_t count, uint64_t seed, uint64_t stream,
+                     uint64_t threshold)
+{
+    // Partial blocks at either end, whole blocks in between
+    size_t i = 0;
+    while (i < count && (first + i) % 4 != 0) {
+        uint64_t index = first + i;
+        cells[i++] = philox4x32(index / 4, stream, seed).words[index % 4] < threshold ? 1 : 0;
+    }
+    for (; i + 4 <= count; i += 4) {
+        PhiloxBlock block = philox4x32((first + i) / 4, stream, seed);
+        cells[i] = block.words[0] < threshold ? 1 : 0;
+        cells[i + 1] = block.words[1] < threshold ? 1 : 0;
+        cells[i + 2] = block.words[2] < threshold ? 1 : 0;
+        cells[i + 3] = block.words[3] < threshold ? 1 : 0;
+    }
+    for (; i < count; ++i) {
+        uint64_t index = first + i;
+        cells[i] = philox4x32(index / 4, stream, seed).words[index % 4] < threshold ? 1 : 0;
+    }
+}
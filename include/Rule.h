@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+// Outer-totalistic rule on the toroidal grid. State 1 is alive and only live
+// cells are counted as neighbours. Generations rules add dying states
+// 2 .. states - 1: a live cell that does not survive starts dying, and dying
+// cells age by one state per generation until they are dead again.
+struct Rule {
+    // Range-1 rules: bit n is set if n live neighbours give birth to a dead
+    // cell or keep a live cell alive
+    uint32_t birth = 1u << 3;
+    uint32_t survival = (1u << 2) | (1u << 3);
+    int states = 2;
+
+    // Larger than Life: neighbours within range cells, in a square (Moore)
+    // or diamond (von Neumann) neighbourhood, with birth and survival given
+    // as inclusive count intervals
+    int range = 1;
+    bool vonNeumann = false;
+    bool countCenter = false;   // the cell itself is one of its neighbours
+    int birthMin = 0;
+    int birthMax = -1;
+    int survivalMin = 0;
+    int survivalMax = -1;
+
+    bool isConway() const;
+    // Two states and the 3x3 neighbourhood: the rules BitGrid and HashLife run
+    bool isLifeLike() const;
+    // Counts use the intervals rather than the masks
+    bool isLargerThanLife() const;
+    bool born(int count) const;
+    bool survives(int count) const;
+
+    bool operator==(const Rule& other) const;
+    bool operator!=(const Rule& other) const;
+};
+
+// Accepts B/S notation ("B36/S23"), the older S/B notation ("23/36"),
+// Generations rules ("B2/S/C3" or "/2/3"), Larger than Life rules in
+// Golly's notation ("R5,C0,M1,S34..58,B34..45,NM") and a few names such as
+// "life", "highlife", "daynight", "seeds" and "briansbrain".
+// Throws std::invalid_argument if the text is not a valid rule.
+Rule parseRule(const std::string& text);
+
+// Canonical text of a rule, in the notation of its family
+std::string ruleToString(const Rule& rule);
+
+// Build options that specialize the OpenCL kernels for a rule; the macros
+// in ruleKernelMacros() turn them into the next-state function
+std::string ruleBuildOptions(const Rule& rule);
+const char* ruleKernelMacros();
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Instruction sets SimdLife can use
+enum class SimdIsa {
+    Scalar,
+    AVX2,     // 32 cells per instruction
+    AVX512,   // 64 cells per instruction, needs AVX-512BW
+    Neon      // 16 cells per instruction, AArch64
+};
+
+// Toroidal world stored as one byte per cell for the SIMD CPU engine. Each
+// row is computed with a separable 3x3 box sum: column sums of the rows
+// above, at and below it go into a row buffer whose two ends are copied
+// from the opposite edge, then every cell adds three neighbouring column
+// sums and looks its next state up in a 16-entry table. Only the wrapped
+// rows (by pointer) and columns (the two copied sums) are special cases.
+class SimdLife {
+private:
+    size_t m_width;
+    size_t m_height;
+    std::vector<uint8_t> m_current;
+    std::vector<uint8_t> m_next;
+    std::vector<uint8_t> m_columnSums;  // m_width + 2 entries, wrapped at both ends
+    // Next state by box sum (the cell included): 16 bytes for dead cells
+    // repeated four times, then the same for live cells. Every 128-bit lane
+    // of a 512-bit register gets its copy from one plain load.
+    uint8_t m_tables[128];
+    SimdIsa m_isa;
+
+public:
+    SimdLife(size_t width, size_t height);
+
+    void pack(const std::vector<int>& cells);
+    void unpack(std::vector<int>& cells) const;
+
+    // Any two-state rule with the 3x3 neighbourhood; B3/S23 by default
+    void setRule(uint32_t birth, uint32_t survival);
+    // An instruction set the CPU lacks is replaced by bestIsa()
+    void setIsa(SimdIsa isa);
+    SimdIsa getIsa() const;
+    void evolve(int generations = 1);
+
+    // Runtime CPU feature detection
+    static bool isSupported(SimdIsa isa);
+    static SimdIsa bestIsa();
+    static const char* isaName(SimdIsa isa);
+    // Accepts the isaName() names; throws std::invalid_argument otherwise
+    static SimdIsa parseIsa(const std::string& name);
+};
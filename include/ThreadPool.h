@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+// Reusable rendezvous point for a fixed number of threads.
+class Barrier {
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    unsigned m_count;
+    unsigned m_waiting;
+    uint64_t m_phase;
+
+public:
+    explicit Barrier(unsigned count);
+    void wait();
+};
+
+// Fixed set of worker threads that live for the lifetime of the pool.
+// run() hands the same task to every worker (the calling thread acts as
+// worker 0) and returns once all of them have finished it.
+class ThreadPool {
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+    const std::function<void(unsigned)>* m_task;
+    uint64_t m_round;
+    unsigned m_pending;
+    bool m_stopping;
+
+    void workerLoop(unsigned index);
+
+public:
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void run(const std::function<void(unsigned)>& task);
+    unsigned size() const;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <CL/cl.h>
+#include "Rule.h"
+#include "ThreadPool.h"
+
+// Outcome of one world of a WorldBatch run. A world has settled once it
+// equals its state one generation earlier (period 1: still lifes) or two
+// generations earlier (period 2: blinkers, toads, beacons), which covers
+// what most random soups end in. Generations count from the start of the run.
+struct BatchWorldResult {
+    size_t population = 0;
+    int64_t settledAt = -1;  // first generation of the repeating state; -1 if not settled
+    int period = 0;          // 1 or 2 once settled
+};
+
+// Many independent toroidal worlds of the same size, evolved together for
+// parameter sweeps. The cells of all worlds live in one array, one byte
+// per cell, world after world. On the CPU every world is evolved bit-packed
+// by one worker of a work-stealing pool; on OpenCL all worlds share one
+// context and one buffer and advance with a single launch per generation.
+// Settled worlds are not computed any further on either path.
+class WorldBatch {
+public:
+    // Two-state rules with the 3x3 neighbourhood only; throws
+    // std::invalid_argument for other rules or empty dimensions
+    WorldBatch(size_t width, size_t height, size_t count, const Rule& rule = Rule());
+    ~WorldBatch();
+
+    WorldBatch(const WorldBatch&) = delete;
+    WorldBatch& operator=(const WorldBatch&) = delete;
+
+    size_t getWidth() const;
+    size_t getHeight() const;
+    size_t getCount() const;
+
+    // World index starts with cells as given (row-major, width x height)
+    void setWorld(size_t index, const std::vector<int>& cells);
+    std::vector<int> getWorld(size_t index) const;
+    // Random soups: each cell is alive with the given probability, drawn
+    // from the seed, the world index and the cell index (see RandomFill.h),
+    // so a batch is reproducible and any one world can be regenerated on its own
+    void randomize(double density, uint64_t seed);
+
+    // Each run starts from the current cells, leaves the final cells in
+    // getCells() and replaces the results
+    void evolveThreaded(int generations, unsigned threadCount = 0);
+    // Selector as for findOpenCLDevice(); the context is kept for later runs
+    bool initializeOpenCL(const std::string& device = std::string());
+    bool evolveOpenCL(int generations);
+
+    // count * width * height states, world after world
+    const std::vector<uint8_t>& getCells() const;
+    const std::vector<BatchWorldResult>& getResults() const;
+    // Name of the device initializeOpenCL() chose
+    const std::string& getOpenCLDeviceName() const;
+
+private:
+    size_t m_width;
+    size_t m_height;
+    size_t m_count;
+    Rule m_rule;
+    std::vector<uint8_t> m_cells;
+    std::vector<BatchWorldResult> m_results;
+    std::unique_ptr<ThreadPool> m_threadPool;
+
+    cl_context m_context;
+    cl_command_queue m_queue;
+    cl_program m_program;
+    cl_kernel m_kernel;
+    cl_mem m_grids[2];
+    cl_mem m_changes;   // three slots of two change flags per world
+    cl_mem m_settled;   // settledAt and period per world
+    std::string m_deviceName;
+
+    void evolveWorld(size_t index, int generations);
+    void cleanupOpenCL();
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+class MappedFile;
+
+enum class WorldFileFormat {
+    Text,       // "width height" followed by one integer per cell
+    Binary,     // bit-packed rows in BitGrid's word layout
+    BinaryRLE   // alternating dead/alive run lengths as varints; worlds with
+                // more than two states store (run length, state) varint pairs
+};
+
+// Binary world files start with a fixed little-endian header:
+//   0  magic "GOLW"          4  version
+//   8  width                16  height
+//  24  generation           32  encoding (0 = bit-packed, 1 = RLE)
+//  40  payload size in bytes
+//  48  CRC-32 of the payload   52  cell states (0 in older files means 2)
+//  56  length of the rule text stored after the payload (0 if none)
+// The payload starts at byte 64, so bit-packed rows are 8-byte aligned.
+// The rule text is not covered by the checksum; it is validated by parsing.
+// Worlds with more than two states are written as version 2, which older
+// readers reject instead of loading every dying cell as alive.
+struct WorldFileHeader {
+    uint64_t width;
+    uint64_t height;
+    uint64_t generation;
+    WorldFileFormat format;
+    uint64_t payloadSize;
+    uint32_t checksum;
+    int states;          // 2 for alive/dead worlds; text files always report 2
+    uint32_t ruleSize;   // bytes of rule text after the payload
+    std::string rule;    // the world's rule (see ruleToString()); empty if none
+};
+
+static const size_t worldFileHeaderSize = 64;
+
+// Loads either format; binary files are recognised by their magic number
+// and come back with their rule text, if they have one.
+// Throws std::runtime_error on I/O errors, malformed data or a bad checksum.
+WorldFileHeader loadWorldFile(const std::string& filename, std::vector<int>& cells);
+
+// With states == 2 every non-zero cell is saved as alive; otherwise cells
+// must lie in [0, states). Bit-packed files only hold two states, so
+// Binary with more throws std::invalid_argument. A non-empty rule is
+// stored after the payload of binary files; text files have no room for it.
+void saveWorldFile(const std::string& filename, const std::vector<int>& cells,
+                   size_t width, size_t height, WorldFileFormat format,
+                   uint64_t generation = 0, int states = 2, const std::string& rule = std::string());
+
+// Parses a binary header (without the rule text, see ruleSize); returns
+// false if the bytes do not start with one
+bool parseWorldFileHeader(const unsigned char* bytes, size_t size, WorldFileHeader& header);
+
+// Maps a binary world file for in-place use. Only bit-packed payloads can be
+// read straight from the mapping; returns false (and leaves the file closed)
+// for text and RLE files, which still have to be streamed.
+bool mapWorldFile(const std::string& filename, MappedFile& file, WorldFileHeader& header);
+
+// Throws if the mapped payload does not match the checksum in its header
+void verifyMappedWorld(const MappedFile& file, const WorldFileHeader& header);
+void unpackMappedWorld(const MappedFile& file, const WorldFileHeader& header, std::vector<int>& cells);
+
+// Writes a bit-packed binary world through a writable mapping of the output
+void saveMappedWorldFile(const std::string& filename, const std::vector<int>& cells,
+                         size_t width, size_t height, uint64_t generation = 0,
+                         const std::string& rule = std::string());
+
+uint32_t worldFileCrc32(uint32_t crc, const unsigned char* data, size_t size);
@@ -1,13 +1,51 @@
 import pandas as pd
 import matplotlib.pyplot as plt
 
-df = pd.read_csv('simulation_results.csv')
+df = pd.read_csv('benchmark_results.csv')
+
+# Throughput against grid size for every engine
+sizes = df[df['Group'] == 'size']
 plt.figure(figsize=(10,6))
-plt.plot(df['Width'], df['Elapsed Time (s)'], marker='o')
+for engine, group in sizes.groupby('Engine'):
+    group = group.sort_values('Width')
+    plt.plot(group['Width'] * group['Height'], group['Cells/s'], marker='o', label=engine)
 plt.xscale('log')
 plt.yscale('log')
-plt.xlabel('Grid Size (width=height)')
-plt.ylabel('Time (seconds)')
-plt.title('OpenCL Evolution Performance (n=1)')
+plt.xlabel('Cells (width x height)')
+plt.ylabel('Cell updates per second (median)')
+plt.title('Game of Life Engine Throughput')
+plt.legend()
 plt.grid(True)
 plt.savefig('performance_plot.png')
+
+# Throughput against initial density
+densities = df[df['Group'] == 'density']
+plt.figure(figsize=(10,6))
+for engine, group in densities.groupby('Engine'):
+    group = group.sort_values('Density')
+    plt.plot(group['Density'], group['Cells/s'], marker='o', label=engine)
+plt.yscale('log')
+plt.xlabel('Initial density')
+plt.ylabel('Cell updates per second (median)')
+plt.title('Throughput by Initial Density')
+plt.legend()
+plt.grid(True)
+plt.savefig('density_plot.png')
+
+# Where the time goes on the OpenCL engines
+opencl = sizes[sizes['Engine'].str.startswith('opencl')]
+if not opencl.empty:
+    labels = opencl['Engine'] + ' ' + opencl['Width'].astype(str)
+    phases = ['Setup (s)', 'Upload (s)', 'Compute Median (s)', 'Download (s)']
+    plt.figure(figsize=(12,6))
+    bottom = None
+    for phase in phases:
+        plt.bar(labels, opencl[phase], bottom=bottom, label=phase)
+        bottom = opencl[phase].values if bottom is None else bottom + opencl[phase].values
+    plt.yscale('log')
+    plt.xticks(rotation=45, ha='right')
+    plt.ylabel('Time (seconds)')
+    plt.title('OpenCL Time per Phase')
+    plt.legend()
+    plt.tight_layout()
+    plt.savefig('opencl_phases_plot.png')
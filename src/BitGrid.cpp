@@ -0,0 +1,220 @@
+#include "../include/BitGrid.h"
+#include <bitset>
+#include <algorithm>
+#include <stdexcept>
+
+// Horizontal neighbours of word i in a packed row, with toroidal wrap.
+// west holds cell x-1 at bit x, east holds cell x+1 at bit x.
+static inline void horizontalNeighbors(const uint64_t* row, size_t i, size_t wordsPerRow,
+                                       unsigned lastBit, uint64_t& west, uint64_t& east)
+{
+    uint64_t word = row[i];
+    uint64_t carryIn = (i > 0) ? (row[i - 1] >> 63)
+                               : ((row[wordsPerRow - 1] >> lastBit) & 1u);
+    uint64_t carryOut = (i + 1 < wordsPerRow) ? (row[i + 1] << 63)
+                                             : ((row[0] & 1u) << lastBit);
+    west = (word << 1) | carryIn;
+    east = (word >> 1) | carryOut;
+}
+
+BitGrid::BitGrid(size_t width, size_t height)
+    : m_width(width), m_height(height), m_birth(1u << 3), m_survival((1u << 2) | (1u << 3))
+{
+    if (m_width == 0 || m_height == 0)
+        throw std::invalid_argument("BitGrid dimensions must be > 0.");
+
+    m_wordsPerRow = (m_width + 63) / 64;
+    unsigned usedBits = static_cast<unsigned>(m_width % 64);
+    m_lastWordMask = usedBits ? ((uint64_t(1) << usedBits) - 1) : ~uint64_t(0);
+
+    m_currentWords.resize(m_wordsPerRow * m_height, 0);
+    m_nextWords.resize(m_wordsPerRow * m_height, 0);
+}
+
+void BitGrid::pack(const std::vector<int>& cells) {
+    if (cells.size() != m_width * m_height)
+        throw std::invalid_argument("BitGrid::pack: grid size mismatch.");
+
+    for (size_t y = 0; y < m_height; ++y) {
+        const int* src = cells.data() + y * m_width;
+        uint64_t* dst = m_currentWords.data() + y * m_wordsPerRow;
+        for (size_t i = 0; i < m_wordsPerRow; ++i) {
+            size_t begin = i * 64;
+            size_t end = (begin + 64 < m_width) ? begin + 64 : m_width;
+            uint64_t word = 0;
+            for (size_t x = begin; x < end; ++x) {
+                if (src[x] != 0)
+                    word |= uint64_t(1) << (x - begin);
+            }
+            dst[i] = word;
+        }
+    }
+}
+
+void BitGrid::loadWords(const unsigned char* rows) {
+    for (size_t i = 0; i < m_currentWords.size(); ++i) {
+        const unsigned char* bytes = rows + i * 8;
+        uint64_t word = 0;
+        for (int b = 0; b < 8; ++b)
+            word |= static_cast<uint64_t>(bytes[b]) << (8 * b);
+        if (i % m_wordsPerRow == m_wordsPerRow - 1)
+            word &= m_lastWordMask;
+        m_currentWords[i] = word;
+    }
+}
+
+void BitGrid::unpack(std::vector<int>& cells) const {
+    cells.resize(m_width * m_height);
+
+    for (size_t y = 0; y < m_height; ++y) {
+        const uint64_t* src = m_currentWords.data() + y * m_wordsPerRow;
+        int* dst = cells.data() + y * m_width;
+        for (size_t x = 0; x < m_width; ++x) {
+            dst[x] = static_cast<int>((src[x / 64] >> (x % 64)) & 1u);
+        }
+    }
+}
+
+template <bool Conway>
+void BitGrid::evolveRow(size_t y) {
+    const size_t n = m_wordsPerRow;
+    const unsigned lastBit = static_cast<unsigned>((m_width - 1) % 64);
+    const uint64_t* up = m_currentWords.data() + ((y + m_height - 1) % m_height) * n;
+    const uint64_t* mid = m_currentWords.data() + y * n;
+    const uint64_t* down = m_currentWords.data() + ((y + 1) % m_height) * n;
+    uint64_t* out = m_nextWords.data() + y * n;
+
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t upWest, upEast, midWest, midEast, downWest, downEast;
+        horizontalNeighbors(up, i, n, lastBit, upWest, upEast);
+        horizontalNeighbors(mid, i, n, lastBit, midWest, midEast);
+        horizontalNeighbors(down, i, n, lastBit, downWest, downEast);
+
+        // Full adders per row: each row contributes sum + 2 * carry neighbours
+        uint64_t upSum = upWest ^ up[i] ^ upEast;
+        uint64_t upCarry = (upWest & up[i]) | (upEast & (upWest ^ up[i]));
+        uint64_t midSum = midWest ^ midEast;
+        uint64_t midCarry = midWest & midEast;
+        uint64_t downSum = downWest ^ down[i] ^ downEast;
+        uint64_t downCarry = (downWest & down[i]) | (downEast & (downWest ^ down[i]));
+
+        // Combine the three row sums into ones + 2 * carry
+        uint64_t ones = upSum ^ midSum ^ downSum;
+        uint64_t onesCarry = (upSum & midSum) | (downSum & (upSum ^ midSum));
+
+        uint64_t pairA = upCarry ^ midCarry;
+        uint64_t bothA = upCarry & midCarry;
+        uint64_t pairB = downCarry ^ onesCarry;
+        uint64_t bothB = downCarry & onesCarry;
+        uint64_t next = 0;
+        if (Conway) {
+            // Neighbour count is 2 or 3 exactly when one of the four weight-2 bits is set
+            uint64_t twoOrThree = (pairA ^ pairB) & ~(bothA | bothB);
+
+            // Count 3 gives birth or survival, count 2 only survival
+            next = twoOrThree & (ones | mid[i]);
+        } else {
+            // Sum the weight-2 bits into count bit planes and OR in every
+            // count that gives birth or survival
+            uint64_t carry = pairA & pairB;
+            uint64_t twos = pairA ^ pairB;
+            uint64_t fours = bothA ^ bothB ^ carry;
+            uint64_t eights = (bothA & bothB) | (carry & (bothA ^ bothB));
+            for (unsigned n = 0; n <= 8; ++n) {
+                if (!(((m_birth | m_survival) >> n) & 1u))
+                    continue;
+                uint64_t count = ((n & 1) ? ones : ~ones) & ((n & 2) ? twos : ~twos)
+                               & ((n & 4) ? fours : ~fours) & ((n & 8) ? eights : ~eights);
+                if ((m_birth >> n) & 1u)
+                    next |= count & ~mid[i];
+                if ((m_survival >> n) & 1u)
+                    next |= count & mid[i];
+            }
+        }
+        if (i + 1 == n)
+            next &= m_lastWordMask;
+        out[i] = next;
+    }
+}
+
+void BitGrid::setRule(uint32_t birth, uint32_t survival) {
+    m_birth = birth;
+    m_survival = survival;
+}
+
+void BitGrid::evolve(int generations) {
+    const bool conway = (m_birth == (1u << 3) && m_survival == ((1u << 2) | (1u << 3)));
+    for (int g = 0; g < generations; ++g) {
+        for (size_t y = 0; y < m_height; ++y) {
+            if (conway)
+                evolveRow<true>(y);
+            else
+                evolveRow<false>(y);
+        }
+        m_currentWords.swap(m_nextWords);
+    }
+}
+
+void BitGrid::setCellState(size_t x, size_t y, int state) {
+    if (x >= m_width || y >= m_height)
+        return;
+    uint64_t& word = m_currentWords[y * m_wordsPerRow + x / 64];
+    uint64_t bit = uint64_t(1) << (x % 64);
+    if (state != 0)
+        word |= bit;
+    else
+        word &= ~bit;
+}
+
+void BitGrid::setRowBits(size_t y, size_t x, const uint64_t* bits, size_t first, size_t count) {
+    if (y >= m_height || x >= m_width)
+        return;
+    count = std::min(count, m_width - x);
+    uint64_t* row = m_currentWords.data() + y * m_wordsPerRow;
+    size_t done = 0;
+    while (done < count) {
+        // Up to one destination word per pass, read from at most two source words
+        size_t column = x + done;
+        size_t shift = column % 64;
+        size_t span = std::min<size_t>(64 - shift, count - done);
+        size_t source = first + done;
+        size_t offset = source % 64;
+        uint64_t value = bits[source / 64] >> offset;
+        if (offset != 0 && offset + span > 64)
+            value |= bits[source / 64 + 1] << (64 - offset);
+        if (span < 64)
+            value &= (uint64_t(1) << span) - 1;
+        row[column / 64] |= value << shift;
+        done += span;
+    }
+}
+
+int BitGrid::getCellState(size_t x, size_t y) const {
+    if (x >= m_width || y >= m_height)
+        return 0;
+    return static_cast<int>((m_currentWords[y * m_wordsPerRow + x / 64] >> (x % 64)) & 1u);
+}
+
+size_t BitGrid::population() const {
+    size_t count = 0;
+    for (uint64_t word : m_currentWords) {
+        count += std::bitset<64>(word).count();
+    }
+    return count;
+}
+
+size_t BitGrid::getWidth() const {
+    return m_width;
+}
+
+size_t BitGrid::getHeight() const {
+    return m_height;
+}
+
+size_t BitGrid::getWordsPerRow() const {
+    return m_wordsPerRow;
+}
+
+const std::vector<uint64_t>& BitGrid::getWords() const {
+    return m_currentWords;
+}
@@ -8,7 +8,8 @@
 #include <vector>
 #include <unordered_map>
 #include <functional>
-#include <sstream>
+#include <algorithm>
+#include <iomanip>
 
 constexpr size_t hash(const char* str) {
     return str[0] ? std::hash<char>{}(str[0]) + 33 * hash(str + 1) : 5381;
@@ -18,7 +19,10 @@ size_t hash(const std::string& str) {
 }
 
 CLI::CLI()
-    : world(nullptr), printAfterGeneration(false), delayMs(0)
+    : world(nullptr), printAfterGeneration(false), delayMs(0), threadCount(0), snapshotInterval(0),
+      kernelVariant(GameOfLife::KernelVariant::Naive), blockDepth(4),
+      cellStorage(GameOfLife::CellStorage::Int), profileOpenCL(false), multiSubDevices(0),
+      maxCyclePeriod(64), simdIsa(SimdLife::bestIsa()), autosavesReported(0)
 {
 }
 
@@ -47,20 +51,90 @@ void CLI::processCommand(const std::string& command) {
 
     static const std::unordered_map<std::string, std::function<void(std::istringstream&)>> commandMap = {
         { "create", [this](std::istringstream&){ createWorld(); } },
-        { "load",   [this](std::istringstream&){ loadWorld(); } },
-        { "save",   [this](std::istringstream&){ saveWorld(); } },
+        { "load",   [this](std::istringstream& iss){
+            std::string option;
+            iss >> option;
+            loadWorld(option == "mmap");
+        }},
+        { "save",   [this](std::istringstream& iss){
+            std::string format;
+            iss >> format;
+            saveWorld(format);
+        }},
         { "run",    [this](std::istringstream& iss){
             std::string mode;
             int generations = 0;
             iss >> mode >> generations;
             runEvolution(mode, generations);
         }},
+        { "checkpoint", [this](std::istringstream&){ saveCheckpoint(); } },
+        { "autosave", [this](std::istringstream& iss){
+            std::string interval, filename, format;
+            iss >> interval >> filename >> format;
+            if (interval == "off") {
+                autosave.reset();
+                std::cout << "Autosave disabled.\n";
+                return;
+            }
+            if (!interval.empty()) {
+                // "<n>" counts generations, "<t>s" seconds
+                bool seconds = interval.back() == 's';
+                double value = 0;
+                std::istringstream number(seconds ? interval.substr(0, interval.size() - 1) : interval);
+                if (!(number >> value) || value <= 0 || filename.empty()
+                    || !(format.empty() || format == "rle" || format == "binary")) {
+                    std::cout << "Please use 'autosave <n> <file> [rle|binary]', 'autosave <t>s <file> [rle|binary]' or 'autosave off'.\n";
+                    return;
+                }
+                try {
+                    autosave.reset();
+                    autosave.reset(new CheckpointWriter(filename, format == "binary" ? WorldFileFormat::Binary
+                                                                                     : WorldFileFormat::BinaryRLE));
+                } catch (const std::exception& e) {
+                    std::cout << e.what() << "\n";
+                    return;
+                }
+                autosaveSchedule = seconds ? CheckpointSchedule(0, value) : CheckpointSchedule(static_cast<int>(value));
+                autosavesReported = 0;
+            }
+            if (!autosave)
+                std::cout << "Autosave disabled.\n";
+            else if (autosaveSchedule.getEveryGenerations() > 0)
+                std::cout << "Autosave to '" << autosave->getFilename() << "' every "
+                          << autosaveSchedule.getEveryGenerations() << " generation(s).\n";
+            else
+                std::cout << "Autosave to '" << autosave->getFilename() << "' every "
+                          << autosaveSchedule.getEverySeconds() << " second(s).\n";
+        }},
+        { "resume", [this](std::istringstream& iss){
+            std::string filename;
+            iss >> filename;
+            if (filename.empty() && autosave) {
+                // Make sure the latest checkpoint is on disk
+                reportAutosave();
+                filename = autosave->getFilename();
+            }
+            if (filename.empty()) {
+                std::cout << "Please use 'resume <file>' or set up 'autosave' first.\n";
+                return;
+            }
+            openWorld(filename, false);
+        }},
         { "set",    [this](std::istringstream&){ setCellState(); } },
         { "get",    [this](std::istringstream&){ getCellState(); } },
-        { "glider", [this](std::istringstream&){ addGlider(); } },
-        { "toad",   [this](std::istringstream&){ addToad(); } },
-        { "beacon", [this](std::istringstream&){ addBeacon(); } },
-        { "methuselah", [this](std::istringstream&){ addMethuselah(); } },
+        { "glider", [this](std::istringstream&){ addPattern("glider", "Glider"); } },
+        { "toad",   [this](std::istringstream&){ addPattern("toad", "Toad"); } },
+        { "beacon", [this](std::istringstream&){ addPattern("beacon", "Beacon"); } },
+        { "methuselah", [this](std::istringstream&){ addPattern("methuselah", "Methuselah (R-Pentomino)", -1); } },
+        { "pattern", [this](std::istringstream& iss){
+            std::string name;
+            iss >> name;
+            if (name.empty()) {
+                std::cout << "Please use 'pattern <name or file>'.\n";
+                return;
+            }
+            addPattern(name, "Pattern '" + name + "'");
+        }},
         { "print",  [this](std::istringstream& iss){
             std::string mode;
             iss >> mode;
@@ -77,6 +151,131 @@ void CLI::processCommand(const std::string& command) {
             iss >> delayMs;
             std::cout << "Delay set to " << delayMs << " ms.\n";
         }},
+        { "threads", [this](std::istringstream& iss){
+            iss >> threadCount;
+            if (threadCount == 0)
+                std::cout << "Thread count set to hardware concurrency.\n";
+            else
+                std::cout << "Thread count set to " << threadCount << ".\n";
+        }},
+        { "snapshot", [this](std::istringstream& iss){
+            iss >> snapshotInterval;
+            if (snapshotInterval > 0)
+                std::cout << "OpenCL snapshots every " << snapshotInterval << " generation(s).\n";
+            else
+                std::cout << "OpenCL snapshots disabled.\n";
+        }},
+        { "kernel", [this](std::istringstream& iss){
+            std::string name;
+            iss >> name;
+            if (name == "naive")
+                kernelVariant = GameOfLife::KernelVariant::Naive;
+            else if (name == "tiled")
+                kernelVariant = GameOfLife::KernelVariant::Tiled;
+            else if (name == "blocked") {
+                kernelVariant = GameOfLife::KernelVariant::TemporalBlocked;
+                int depth = 0;
+                if (iss >> depth && depth > 0)
+                    blockDepth = depth;
+            } else
+                std::cout << "Please use 'kernel naive', 'kernel tiled' or 'kernel blocked [depth]'.\n";
+            std::cout << "OpenCL kernel: ";
+            if (kernelVariant == GameOfLife::KernelVariant::Tiled)
+                std::cout << "tiled" << std::endl;
+            else if (kernelVariant == GameOfLife::KernelVariant::TemporalBlocked)
+                std::cout << "blocked (" << blockDepth << " generations per launch)" << std::endl;
+            else
+                std::cout << "naive" << std::endl;
+        }},
+        { "profile", [this](std::istringstream& iss){
+            std::string mode;
+            iss >> mode;
+            if (mode == "on")
+                profileOpenCL = true;
+            else if (mode == "off")
+                profileOpenCL = false;
+            else
+                std::cout << "Please use 'profile on' or 'profile off'.\n";
+            std::cout << "OpenCL profiling: " << (profileOpenCL ? "enabled" : "disabled") << std::endl;
+        }},
+        { "devices", [this](std::istringstream&){ listDevices(); } },
+        { "device", [this](std::istringstream& iss){
+            std::string selector;
+            std::getline(iss >> std::ws, selector);
+            deviceSelector = (selector == "default") ? std::string() : selector;
+            if (deviceSelector.empty())
+                std::cout << "OpenCL device: default ($GOL_OPENCL_DEVICE, else the first GPU)" << std::endl;
+            else
+                std::cout << "OpenCL device: " << deviceSelector << std::endl;
+        }},
+        { "multidevice", [this](std::istringstream& iss){
+            std::string devices;
+            unsigned subDevices = 0;
+            iss >> devices >> subDevices;
+            multiDevices = (devices == "all") ? std::string() : devices;
+            multiSubDevices = subDevices;
+            std::cout << "Multi-device OpenCL: " << (multiDevices.empty() ? "all devices" : multiDevices);
+            if (multiSubDevices > 1)
+                std::cout << ", " << multiSubDevices << " sub-devices each";
+            std::cout << std::endl;
+        }},
+        { "rule", [this](std::istringstream& iss){
+            std::string text;
+            std::getline(iss >> std::ws, text);
+            if (!text.empty()) {
+                try {
+                    rule = parseRule(text);
+                } catch (const std::exception& e) {
+                    std::cout << e.what() << "\n";
+                }
+            }
+            std::cout << "Rule: " << ruleToString(rule) << std::endl;
+        }},
+        { "cycles", [this](std::istringstream& iss){
+            int period = 0;
+            if (iss >> period)
+                maxCyclePeriod = std::max(0, period);
+            if (maxCyclePeriod > 0)
+                std::cout << "'scalar' and 'opencl' runs stop at cycles of up to " << maxCyclePeriod << " generation(s).\n";
+            else
+                std::cout << "Cycle detection disabled.\n";
+        }},
+        { "simd", [this](std::istringstream& iss){
+            std::string name;
+            iss >> name;
+            try {
+                if (name == "auto")
+                    simdIsa = SimdLife::bestIsa();
+                else if (!name.empty())
+                    simdIsa = SimdLife::parseIsa(name);
+                if (!SimdLife::isSupported(simdIsa)) {
+                    std::cout << "This CPU does not support " << SimdLife::isaName(simdIsa) << ".\n";
+                    simdIsa = SimdLife::bestIsa();
+                }
+            } catch (const std::exception& e) {
+                std::cout << e.what() << "\n";
+            }
+            std::cout << "SIMD instruction set: " << SimdLife::isaName(simdIsa) << std::endl;
+        }},
+        { "storage", [this](std::istringstream& iss){
+            std::string name;
+            iss >> name;
+            if (name == "int")
+                cellStorage = GameOfLife::CellStorage::Int;
+            else if (name == "uchar")
+                cellStorage = GameOfLife::CellStorage::UChar;
+            else if (name == "bits")
+                cellStorage = GameOfLife::CellStorage::BitPacked;
+            else
+                std::cout << "Please use 'storage int', 'storage uchar' or 'storage bits'.\n";
+            std::cout << "OpenCL cell storage: ";
+            if (cellStorage == GameOfLife::CellStorage::UChar)
+                std::cout << "uchar" << std::endl;
+            else if (cellStorage == GameOfLife::CellStorage::BitPacked)
+                std::cout << "bits (bit-packed kernel)" << std::endl;
+            else
+                std::cout << "int" << std::endl;
+        }},
         { "help",   [this](std::istringstream&){ printHelp(); } },
         { "set1d",  [this](std::istringstream&){ setCellState1D(); } },
         { "get1d",  [this](std::istringstream&){ getCellState1D(); } }
@@ -93,17 +292,35 @@ void CLI::processCommand(const std::string& command) {
 void CLI::printHelp() const {
     std::cout << "\nAvailable commands:" << std::endl;
     std::cout << "  create          : Create a new world (asks for width and height)" << std::endl;
-    std::cout << "  load            : Load world from file (asks for filename)" << std::endl;
-    std::cout << "  save            : Save current world to file (asks for filename)" << std::endl;
-    std::cout << "  run <mode> <n>  : Run evolution for n generations. Mode: 'scalar' or 'opencl'" << std::endl;
+    std::cout << "  load [mmap]     : Load world from a text or binary file (asks for filename); 'mmap' maps bit-packed files" << std::endl;
+    std::cout << "  save [format]   : Save current world to file (asks for filename). Format: 'text' (default), 'binary' or 'rle'" << std::endl;
+    std::cout << "  checkpoint      : Save a bit-packed binary checkpoint through a mapped file (asks for filename)" << std::endl;
+    std::cout << "  autosave <n|ts> <file> [rle|binary] : Checkpoint every n generations or t seconds in the background ('off' to stop)" << std::endl;
+    std::cout << "  resume [file]   : Load a checkpoint with its generation (default: the autosave file)" << std::endl;
+    std::cout << "  run <mode> <n>  : Run evolution for n generations. Mode: 'scalar', 'simd', 'threaded', 'bitpacked', 'sparse', 'hashlife', 'opencl' or 'multi'" << std::endl;
     std::cout << "  set             : Set cell state (asks for x, y and state)" << std::endl;
     std::cout << "  get             : Get cell state (asks for x and y)" << std::endl;
     std::cout << "  glider          : Add a glider pattern" << std::endl;
     std::cout << "  toad            : Add a toad pattern" << std::endl;
     std::cout << "  beacon          : Add a beacon pattern" << std::endl;
     std::cout << "  methuselah      : Add a methuselah pattern" << std::endl;
+    std::cout << "  pattern <name>  : Add a built-in pattern (";
+    for (size_t i = 0; i < patterns.getBuiltinNames().size(); ++i)
+        std::cout << (i ? ", " : "") << patterns.getBuiltinNames()[i];
+    std::cout << ") or an RLE / Life 1.06 file" << std::endl;
     std::cout << "  print on/off    : Enable/disable printing after each generation" << std::endl;
     std::cout << "  delay <ms>      : Set delay (ms) for printing" << std::endl;
+    std::cout << "  kernel <name>   : Select the OpenCL kernel: 'naive', 'tiled' or 'blocked [depth]'" << std::endl;
+    std::cout << "  rule <rule>     : Set the rule, e.g. 'B36/S23', 'B2/S/C3', 'R5,C0,M1,S34..58,B34..45,NM' or 'highlife'" << std::endl;
+    std::cout << "  cycles <p>      : Stop 'scalar' and 'opencl' runs once the world repeats with a period of up to p generations (0 = off)" << std::endl;
+    std::cout << "  simd <isa>      : Select the instruction set for 'simd' mode: 'auto' (best supported), 'scalar', 'avx2', 'avx512' or 'neon'" << std::endl;
+    std::cout << "  storage <type>  : Select the OpenCL cell storage: 'int', 'uchar' or 'bits' (bit-packed, own kernel)" << std::endl;
+    std::cout << "  snapshot <k>    : Report population every k generations in 'opencl' mode (0 = off)" << std::endl;
+    std::cout << "  threads <k>     : Set worker threads for 'threaded' mode (0 = all cores)" << std::endl;
+    std::cout << "  devices         : List OpenCL devices" << std::endl;
+    std::cout << "  device <sel>    : Select the OpenCL device by index, name, 'auto' (fastest for this world) or 'default'" << std::endl;
+    std::cout << "  multidevice <devices|all> [k] : Devices for 'multi' mode (comma-separated selectors), split into k sub-devices each" << std::endl;
+    std::cout << "  profile on/off  : Report build, upload, kernel and readback times after 'opencl' runs" << std::endl;
     std::cout << "  help            : Show this help" << std::endl;
     std::cout << "  exit / quit     : Exit the program\n" << std::endl;
 }
@@ -121,21 +338,32 @@ void CLI::createWorld() {
     std::cout << "New world created (" << width << " x " << height << ")." << std::endl;
 }
 
-void CLI::loadWorld() {
+void CLI::loadWorld(bool memoryMap) {
     std::string filename;
     std::cout << "Filename to load: ";
     std::cin >> filename;
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    openWorld(filename, memoryMap);
+}
+
+void CLI::openWorld(const std::string& filename, bool memoryMap) {
     try {
         delete world;
-        world = new GameOfLife(filename);
-        std::cout << "World loaded from '" << filename << "'." << std::endl;
+        world = nullptr;
+        world = new GameOfLife(filename, memoryMap);
+        std::cout << "World loaded from '" << filename << "'";
+        if (world->getGeneration() > 0)
+            std::cout << " at generation " << world->getGeneration();
+        std::cout << "." << std::endl;
     } catch (const std::exception& e) {
         std::cout << "Error loading world: " << e.what() << std::endl;
     }
 }
 
 void CLI::runEvolution(const std::string& mode, int generations) {
+    if (world)
+        world->setRule(rule);
+    autosaveSchedule.start();
     if (mode == "opencl") {
         if (!world) {
             std::cout << "No world loaded.\n";
@@ -145,31 +373,104 @@ void CLI::runEvolution(const std::string& mode, int generations) {
         std::cout << "Running OpenCL evolution for " << generations << " generation(s)...\n";
         auto start = std::chrono::steady_clock::now();
         
-        bool success = world->evolveOpenCL(generations);
+        // Generations reported below count from the start of the run, which
+        // autosave splits into several evolveOpenCL() calls
+        const uint64_t startGeneration = world->getGeneration();
+        int chunkStart = 0;
+        auto onSnapshot = [&](int generation, const std::vector<int>& grid) {
+            std::cout << "Generation " << chunkStart + generation << ": population "
+                      << std::count(grid.begin(), grid.end(), 1) << "\n";
+        };
+        world->setCellStorage(cellStorage);
+        world->setKernelVariant(kernelVariant);
+        world->setTemporalBlockDepth(blockDepth);
+        world->setOpenCLDevice(deviceSelector);
+        world->setOpenCLProfiling(profileOpenCL);
+        world->resetOpenCLProfile();
+        // Grid hashes are computed on the device after every generation
+        CycleDetector cycles(maxCyclePeriod);
+        GameOfLife::HashCallback onHash;
+        int generationsRun = generations;
+        if (maxCyclePeriod > 0) {
+            cycles.record(0, world->getGridHash());
+            onHash = [&](int generation, uint64_t hash) {
+                generationsRun = chunkStart + generation;
+                return cycles.record(static_cast<uint64_t>(generationsRun), hash);
+            };
+        }
+        int initializations = world->getOpenCLStartup().initializations;
+        bool success = true;
+        evolveInChunks(generations, [&](int chunk) {
+            chunkStart = static_cast<int>(world->getGeneration() - startGeneration);
+            success = world->evolveOpenCL(chunk, snapshotInterval, onSnapshot, onHash);
+            return success && !cycles.isPeriodic();
+        });
+        // Include the final readback in the profile
+        if (success && profileOpenCL)
+            world->getCurrentGrid();
         
         auto end = std::chrono::steady_clock::now();
         auto duration = std::chrono::duration<double>(end - start);
         
         if (success) {
+            if (cycles.isPeriodic()) {
+                reportCycle(cycles);
+                if (generationsRun < generations)
+                    std::cout << "Stopped after generation " << generationsRun << ".\n";
+            }
             std::cout << "OpenCL evolution completed in " << duration.count() << " seconds.\n";
+            const GameOfLife::OpenCLStartup& startup = world->getOpenCLStartup();
+            if (startup.initializations != initializations)
+                std::cout << "OpenCL initialized on " << startup.deviceName << " in " << startup.initMs << " ms (program "
+                          << (startup.programFromCache ? "loaded from the binary cache" : "built from source") << ").\n";
+            if (profileOpenCL)
+                printProfile(world->getOpenCLProfile());
             if (printAfterGeneration) {
                 world->print();
             }
         } else {
             std::cout << "OpenCL evolution failed.\n";
         }
+    } else if (mode == "multi") {
+        if (!world) {
+            std::cout << "No world loaded.\n";
+            return;
+        }
+
+        std::cout << "Running multi-device OpenCL evolution for " << generations << " generation(s)...\n";
+        auto start = std::chrono::steady_clock::now();
+        bool success = evolveInChunks(generations, [&](int chunk) {
+            return world->evolveMultiDevice(chunk, multiDevices, multiSubDevices);
+        });
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration<double>(end - start);
+
+        if (success) {
+            std::cout << "Multi-device evolution completed in " << duration.count() << " seconds.\n";
+            for (const std::string& strip : world->getMultiDeviceStrips())
+                std::cout << "  " << strip << "\n";
+            if (printAfterGeneration) {
+                world->print();
+            }
+        } else {
+            std::cout << "Multi-device evolution failed.\n";
+        }
     } else if (mode == "scalar") {
         if(world) {
             auto start = std::chrono::steady_clock::now();
+            // evolveScalar() keeps the grid hash up to date incrementally
+            CycleDetector cycles(maxCyclePeriod);
+            if (maxCyclePeriod > 0)
+                cycles.record(0, world->getGridHash());
             for (int i = 0; i < generations; ++i) {
-                std::vector<int> prevGrid = world->getCurrentGrid();
                 world->evolveScalar();
                 if (printAfterGeneration) {
                     world->print();
                     std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
                 }
-                if (world->getCurrentGrid() == prevGrid) {
-                    std::cout << "Stable state reached at generation " << (i+1) << ".\n";
+                autosaveIfDue();
+                if (maxCyclePeriod > 0 && cycles.record(static_cast<uint64_t>(i + 1), world->getGridHash())) {
+                    reportCycle(cycles);
                     break;
                 }
             }
@@ -179,9 +480,181 @@ void CLI::runEvolution(const std::string& mode, int generations) {
         } else {
             std::cout << "No world loaded.\n";
         }
+    } else if (mode == "bitpacked") {
+        if (!world) {
+            std::cout << "No world loaded.\n";
+            return;
+        }
+
+        std::cout << "Running bit-packed evolution for " << generations << " generation(s)...\n";
+        auto start = std::chrono::steady_clock::now();
+
+        evolveInChunks(generations, [&](int chunk) {
+            world->evolveBitPacked(chunk);
+            return true;
+        });
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration<double>(end - start);
+        std::cout << "Bit-packed evolution completed in " << duration.count() << " seconds.\n";
+        if (printAfterGeneration) {
+            world->print();
+        }
+    } else if (mode == "simd") {
+        if (!world) {
+            std::cout << "No world loaded.\n";
+            return;
+        }
+
+        world->setSimdIsa(simdIsa);
+        std::cout << "Running SIMD evolution (" << SimdLife::isaName(world->getSimdIsa()) << ") for "
+                  << generations << " generation(s)...\n";
+        auto start = std::chrono::steady_clock::now();
+
+        evolveInChunks(generations, [&](int chunk) {
+            world->evolveSimd(chunk);
+            return true;
+        });
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration<double>(end - start);
+        std::cout << "SIMD evolution completed in " << duration.count() << " seconds.\n";
+        if (printAfterGeneration) {
+            world->print();
+        }
+    } else if (mode == "threaded") {
+        if (!world) {
+            std::cout << "No world loaded.\n";
+            return;
+        }
+
+        std::cout << "Running threaded evolution for " << generations << " generation(s)...\n";
+        auto start = std::chrono::steady_clock::now();
+
+        evolveInChunks(generations, [&](int chunk) {
+            world->evolveThreaded(chunk, threadCount);
+            return true;
+        });
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration<double>(end - start);
+        std::cout << "Threaded evolution completed in " << duration.count() << " seconds.\n";
+        if (printAfterGeneration) {
+            world->print();
+        }
+    } else if (mode == "sparse") {
+        if (!world) {
+            std::cout << "No world loaded.\n";
+            return;
+        }
+
+        std::cout << "Running sparse evolution for " << generations << " generation(s)...\n";
+        auto start = std::chrono::steady_clock::now();
+
+        evolveInChunks(generations, [&](int chunk) {
+            world->evolveSparse(chunk);
+            return true;
+        });
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration<double>(end - start);
+        const GameOfLife::SparseStats& stats = world->getSparseStats();
+        std::cout << "Sparse evolution completed in " << duration.count() << " seconds.\n";
+        if (stats.generations > 0) {
+            double averageActive = static_cast<double>(stats.totalActiveTiles) / stats.generations;
+            std::cout << "Active tiles: " << stats.lastActiveTiles << " of " << stats.tileCount
+                      << " in the last generation, " << averageActive << " on average ("
+                      << 100.0 * (1.0 - averageActive / stats.tileCount) << "% skipped).\n";
+        }
+        if (printAfterGeneration) {
+            world->print();
+        }
+    } else if (mode == "hashlife") {
+        if (!world) {
+            std::cout << "No world loaded.\n";
+            return;
+        }
+        if (generations <= 0)
+            return;
+
+        std::cout << "Running HashLife evolution for " << generations << " generation(s)...\n";
+        auto start = std::chrono::steady_clock::now();
+
+        evolveInChunks(generations, [&](int chunk) {
+            world->evolveHashLife(static_cast<uint64_t>(chunk));
+            return true;
+        });
+
+        auto end = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration<double>(end - start);
+        std::cout << "HashLife evolution completed in " << duration.count() << " seconds.\n";
+        if (printAfterGeneration) {
+            world->print();
+        }
     } else {
-        std::cout << "Unrecognized mode. Use 'scalar' or 'opencl'.\n";
+        std::cout << "Unrecognized mode. Use 'scalar', 'simd', 'threaded', 'bitpacked', 'sparse', 'hashlife', 'opencl' or 'multi'.\n";
+    }
+    reportAutosave();
+}
+
+void CLI::reportCycle(const CycleDetector& cycles) const {
+    // Generations count from the start of the run
+    if (cycles.getPeriod() == 1)
+        std::cout << "Stable state reached at generation " << cycles.getCycleStart() << ".\n";
+    else
+        std::cout << "Periodic with period " << cycles.getPeriod() << " from generation "
+                  << cycles.getCycleStart() << " (detected at generation "
+                  << cycles.getCycleStart() + cycles.getPeriod() << ").\n";
+}
+
+bool CLI::evolveInChunks(int generations, const std::function<bool(int)>& evolve) {
+    if (!autosave)
+        return evolve(generations);
+    int done = 0;
+    while (done < generations) {
+        int chunk = autosaveSchedule.generationsUntilDue(world->getGeneration(), generations - done);
+        auto start = std::chrono::steady_clock::now();
+        if (!evolve(chunk))
+            return false;
+        autosaveSchedule.recordChunk(chunk, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        done += chunk;
+        autosaveIfDue();
+    }
+    return true;
+}
+
+void CLI::autosaveIfDue() {
+    if (!autosave || !autosaveSchedule.isDue(world->getGeneration()))
+        return;
+    // Only the copy happens here; the writer thread encodes and writes it
+    try {
+        autosave->submit(world->getCurrentGrid(), world->getWidth(), world->getHeight(), world->getGeneration(),
+                         world->getRule());
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Autosave disabled: " << e.what() << "\n";
+        autosave.reset();
+        return;
+    }
+    autosaveSchedule.markSaved();
+}
+
+void CLI::reportAutosave() {
+    if (!autosave)
+        return;
+    // The run is over, so waiting for the last write costs no evolution time
+    try {
+        autosave->flush();
+    } catch (const std::exception& e) {
+        std::cout << "Autosave failed: " << e.what() << "\n";
+        return;
     }
+    CheckpointWriter::Stats stats = autosave->getStats();
+    if (stats.written == autosavesReported)
+        return;
+    std::cout << "Autosaved generation " << stats.lastGeneration << " to '" << autosave->getFilename() << "' ("
+              << stats.written - autosavesReported << " checkpoint(s) this run, " << stats.replaced
+              << " superseded before writing, " << stats.writeSeconds << " s writing in total).\n";
+    autosavesReported = stats.written;
 }
 
 void CLI::setCellState() {
@@ -246,121 +719,111 @@ void CLI::getCellState1D() {
     std::cout << "Cell state at index " << p << " is: " << state << "\n";
 }
 
-void CLI::saveWorld() {
+void CLI::saveWorld(const std::string& format) {
     if (!world) {
         std::cout << "No world available! Create or load a world first.\n";
         return;
     }
+    WorldFileFormat fileFormat;
+    if (format.empty() || format == "text") {
+        fileFormat = WorldFileFormat::Text;
+    } else if (format == "binary") {
+        fileFormat = WorldFileFormat::Binary;
+    } else if (format == "rle") {
+        fileFormat = WorldFileFormat::BinaryRLE;
+    } else {
+        std::cout << "Please use 'save', 'save text', 'save binary' or 'save rle'.\n";
+        return;
+    }
     std::string filename;
     std::cout << "Filename to save: ";
     std::cin >> filename;
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     try {
-        world->saveToFile(filename);
+        world->saveToFile(filename, fileFormat);
         std::cout << "World saved to '" << filename << "'.\n";
     } catch (const std::exception& e) {
         std::cout << "Error saving world: " << e.what() << "\n";
     }
 }
 
-void CLI::addGlider() {
+void CLI::saveCheckpoint() {
     if (!world) {
-        std::cout << "No world loaded.\n";
+        std::cout << "No world available! Create or load a world first.\n";
         return;
     }
-    
-    size_t x, y;
-    std::string input;
-    std::cout << "Enter coordinates for glider placement (format: x,y): ";
-    std::getline(std::cin, input);
-    
-    if (!parseCoordinates(input, x, y)) {
-        std::cout << "Invalid input format. Please use format: x,y\n";
-        return;
+    std::string filename;
+    std::cout << "Checkpoint filename: ";
+    std::cin >> filename;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    try {
+        world->saveCheckpoint(filename);
+        std::cout << "Checkpoint written to '" << filename << "'.\n";
+    } catch (const std::exception& e) {
+        std::cout << "Error writing checkpoint: " << e.what() << "\n";
     }
-    
-    world->setCellState(x+1, y, 1);
-    world->setCellState(x+2, y+1, 1);
-    world->setCellState(x,   y+2, 1);
-    world->setCellState(x+1, y+2, 1);
-    world->setCellState(x+2, y+2, 1);
-    std::cout << "Glider added at (" << x << "," << y << ").\n";
 }
 
-void CLI::addToad() {
+void CLI::addPattern(const std::string& name, const std::string& label, long long offsetY) {
     if (!world) {
         std::cout << "No world available! Create or load a world first.\n";
         return;
     }
-    
-    size_t x, y;
-    std::string input;
-    std::cout << "Enter coordinates for toad placement (format: x,y): ";
-    std::getline(std::cin, input);
-    
-    if (!parseCoordinates(input, x, y)) {
-        std::cout << "Invalid input format. Please use format: x,y\n";
-        return;
-    }
-    
-    world->setCellState(x+1, y,   1);
-    world->setCellState(x+2, y,   1);
-    world->setCellState(x+3, y,   1);
-    world->setCellState(x,   y+1, 1);
-    world->setCellState(x+1, y+1, 1);
-    world->setCellState(x+2, y+1, 1);
-    std::cout << "Toad added at (" << x << "," << y << ").\n";
-}
 
-void CLI::addBeacon() {
-    if (!world) {
-        std::cout << "No world available! Create or load a world first.\n";
+    const Pattern* pattern = nullptr;
+    try {
+        pattern = &patterns.get(name);
+    } catch (const std::exception& e) {
+        std::cout << "Error loading pattern: " << e.what() << "\n";
         return;
     }
-    
+
     size_t x, y;
     std::string input;
-    std::cout << "Enter coordinates for beacon placement (format: x,y): ";
+    std::cout << "Enter coordinates for " << name << " placement (format: x,y): ";
     std::getline(std::cin, input);
-    
+
     if (!parseCoordinates(input, x, y)) {
         std::cout << "Invalid input format. Please use format: x,y\n";
         return;
     }
-    
-    world->setCellState(x,   y,   1);
-    world->setCellState(x+1, y,   1);
-    world->setCellState(x,   y+1, 1);
-    world->setCellState(x+1, y+1, 1);
-    world->setCellState(x+2, y+2, 1);
-    world->setCellState(x+3, y+2, 1);
-    world->setCellState(x+2, y+3, 1);
-    world->setCellState(x+3, y+3, 1);
-    std::cout << "Beacon added at (" << x << "," << y << ").\n";
+
+    world->stampPattern(*pattern, static_cast<long long>(x), static_cast<long long>(y) + offsetY);
+    std::cout << label << " added at (" << x << "," << y << ").\n";
 }
 
-void CLI::addMethuselah() {
-    if (!world) {
-        std::cout << "No world available! Create or load a world first.\n";
+void CLI::listDevices() const {
+    std::vector<OpenCLDeviceInfo> devices = listOpenCLDevices();
+    if (devices.empty()) {
+        std::cout << "No OpenCL devices found.\n";
         return;
     }
-    
-    size_t x, y;
-    std::string input;
-    std::cout << "Enter coordinates for Methuselah placement (format: x,y): ";
-    std::getline(std::cin, input);
-    
-    if (!parseCoordinates(input, x, y)) {
-        std::cout << "Invalid input format. Please use format: x,y\n";
-        return;
+    size_t defaultIndex = 0;
+    findOpenCLDevice(devices, "", defaultIndex);
+    for (const OpenCLDeviceInfo& info : devices) {
+        std::cout << (info.index == defaultIndex ? "* " : "  ") << info.index << ": " << info.name
+                  << " [" << openclDeviceTypeName(info.type) << ", " << info.platformName << "]\n"
+                  << "     " << info.computeUnits << " compute units, " << info.localMemory / 1024
+                  << " KB local memory, max work-group size " << info.maxWorkGroupSize << "\n";
+    }
+    std::cout << "(* = default device)\n";
+}
+
+void CLI::printProfile(const GameOfLife::OpenCLProfile& profile) const {
+    const std::pair<const char*, const GameOfLife::PhaseStats*> phases[] = {
+        { "build", &profile.build },
+        { "upload", &profile.upload },
+        { "kernel", &profile.kernel },
+        { "readback", &profile.readback }
+    };
+    std::cout << "Phase      Count   Total (ms)   Mean (ms)    P99 (ms)\n";
+    for (const auto& phase : phases) {
+        const GameOfLife::PhaseStats& stats = *phase.second;
+        std::cout << std::left << std::setw(9) << phase.first << std::right
+                  << std::setw(7) << stats.count << std::fixed << std::setprecision(3)
+                  << std::setw(13) << stats.totalMs << std::setw(12) << stats.meanMs
+                  << std::setw(12) << stats.p99Ms << std::defaultfloat << "\n";
     }
-    
-    world->setCellState(x,   y+1, 1);
-    world->setCellState(x+1, y+1, 1);
-    world->setCellState(x,   y,   1);
-    world->setCellState(x+1, y-1, 1);
-    world->setCellState(x+2, y,   1);
-    std::cout << "Methuselah (R-Pentomino) added at (" << x << "," << y << ").\n";
 }
 
 bool CLI::parseCoordinates(const std::string& input, size_t& x, size_t& y) {
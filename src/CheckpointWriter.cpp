@@ -0,0 +1,190 @@
+#include "../include/CheckpointWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+CheckpointWriter::CheckpointWriter(const std::string& filename, WorldFileFormat format)
+    : m_filename(filename), m_format(format), m_pending(), m_writing(),
+      m_hasPending(false), m_busy(false), m_stop(false), m_stats()
+{
+    if (m_filename.empty())
+        throw std::invalid_argument("Checkpoint file name must not be empty.");
+    if (m_format == WorldFileFormat::Text)
+        throw std::invalid_argument("Checkpoints need a binary format to keep the generation.");
+    m_thread = std::thread(&CheckpointWriter::writerLoop, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void CheckpointWriter::submit(const std::vector<int>& cells, size_t width, size_t height, uint64_t generation,
+                              const Rule& rule) {
+    // Rejected here rather than on the writer thread, so the run stops
+    // before it depends on checkpoints that cannot be written
+    if (rule.states > 2 && m_format == WorldFileFormat::Binary)
+        throw std::invalid_argument("Bit-packed checkpoints hold two states; use RLE for rules with " +
+                                    std::to_string(rule.states) + " states.");
+    std::string ruleText = ruleToString(rule);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_hasPending)
+            ++m_stats.replaced;
+        // assign() reuses the buffer's capacity, so steady state is one copy
+        m_pending.cells.assign(cells.begin(), cells.end());
+        m_pending.width = width;
+        m_pending.height = height;
+        m_pending.generation = generation;
+        m_pending.states = rule.states;
+        m_pending.rule.swap(ruleText);
+        m_hasPending = true;
+    }
+    m_wake.notify_one();
+}
+
+void CheckpointWriter::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_hasPending && !m_busy; });
+    if (!m_error.empty()) {
+        std::string error;
+        error.swap(m_error);
+        throw std::runtime_error(error);
+    }
+}
+
+CheckpointWriter::Stats CheckpointWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+const std::string& CheckpointWriter::getFilename() const {
+    return m_filename;
+}
+
+WorldFileFormat CheckpointWriter::getFormat() const {
+    return m_format;
+}
+
+void CheckpointWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_hasPending || m_stop; });
+        if (!m_hasPending)
+            return;
+
+        // Swapping hands the filled buffer to this thread and gives submit()
+        // the one just written, without copying either
+        m_pending.cells.swap(m_writing.cells);
+        m_writing.width = m_pending.width;
+        m_writing.height = m_pending.height;
+        m_writing.generation = m_pending.generation;
+        m_writing.states = m_pending.states;
+        m_writing.rule.swap(m_pending.rule);
+        m_hasPending = false;
+        m_busy = true;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        try {
+            write(m_writing);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        m_busy = false;
+        m_stats.writeSeconds += seconds;
+        if (error.empty()) {
+            ++m_stats.written;
+            m_stats.lastGeneration = m_writing.generation;
+        } else {
+            m_error = error;
+        }
+        if (!m_hasPending)
+            m_idle.notify_all();
+    }
+}
+
+void CheckpointWriter::write(const Snapshot& snapshot) {
+    std::string temporary = m_filename + ".tmp";
+    std::error_code error;
+    try {
+        saveWorldFile(temporary, snapshot.cells, snapshot.width, snapshot.height, m_format, snapshot.generation,
+                      snapshot.states, snapshot.rule);
+    } catch (...) {
+        std::filesystem::remove(temporary, error);
+        throw;
+    }
+    std::filesystem::rename(temporary, m_filename, error);
+    if (error) {
+        std::string reason = error.message();
+        std::filesystem::remove(temporary, error);
+        throw std::runtime_error("Could not replace checkpoint " + m_filename + ": " + reason);
+    }
+}
+
+CheckpointSchedule::CheckpointSchedule(int everyGenerations, double everySeconds)
+    : m_everyGenerations(everyGenerations > 0 ? everyGenerations : 0),
+      m_everySeconds(everyGenerations > 0 || everySeconds < 0 ? 0 : everySeconds),
+      m_lastSave(std::chrono::steady_clock::now()), m_rate(0)
+{
+}
+
+bool CheckpointSchedule::isEnabled() const {
+    return m_everyGenerations > 0 || m_everySeconds > 0;
+}
+
+int CheckpointSchedule::getEveryGenerations() const {
+    return m_everyGenerations;
+}
+
+double CheckpointSchedule::getEverySeconds() const {
+    return m_everySeconds;
+}
+
+void CheckpointSchedule::start() {
+    m_lastSave = std::chrono::steady_clock::now();
+    m_rate = 0;
+}
+
+int CheckpointSchedule::generationsUntilDue(uint64_t generation, int remaining) const {
+    if (m_everyGenerations > 0) {
+        uint64_t period = static_cast<uint64_t>(m_everyGenerations);
+        uint64_t untilDue = period - generation % period;
+        return static_cast<int>(std::min<uint64_t>(untilDue, static_cast<uint64_t>(remaining)));
+    }
+    if (m_everySeconds <= 0)
+        return remaining;
+    if (m_rate <= 0)
+        return std::min(remaining, 1);
+    double left = m_everySeconds
+                - std::chrono::duration<double>(std::chrono::steady_clock::now() - m_lastSave).count();
+    double chunk = std::max(1.0, left * m_rate);
+    return chunk >= remaining ? remaining : static_cast<int>(chunk);
+}
+
+void CheckpointSchedule::recordChunk(int generations, double seconds) {
+    if (generations > 0 && seconds > 0)
+        m_rate = generations / seconds;
+}
+
+bool CheckpointSchedule::isDue(uint64_t generation) const {
+    if (m_everyGenerations > 0)
+        return generation % static_cast<uint64_t>(m_everyGenerations) == 0;
+    if (m_everySeconds <= 0)
+        return false;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_lastSave).count() >= m_everySeconds;
+}
+
+void CheckpointSchedule::markSaved() {
+    m_lastSave = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,61 @@
+#include "../include/CycleDetector.h"
+
+uint64_t gridHash(const std::vector<int>& cells) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < cells.size(); ++i)
+        hash += cellHash(i, cells[i]);
+    return hash;
+}
+
+CycleDetector::CycleDetector(int maxPeriod)
+    : m_maxPeriod(maxPeriod < 1 ? 1 : maxPeriod), m_periodic(false), m_cycleStart(0), m_period(0)
+{
+}
+
+void CycleDetector::reset() {
+    m_history.clear();
+    m_generationOf.clear();
+    m_periodic = false;
+    m_cycleStart = 0;
+    m_period = 0;
+}
+
+bool CycleDetector::record(uint64_t generation, uint64_t hash) {
+    if (m_periodic)
+        return true;
+
+    // Forget generations more than maxPeriod back
+    while (!m_history.empty() && generation - m_history.front().first > static_cast<uint64_t>(m_maxPeriod)) {
+        auto it = m_generationOf.find(m_history.front().second);
+        if (it != m_generationOf.end() && it->second == m_history.front().first)
+            m_generationOf.erase(it);
+        m_history.pop_front();
+    }
+
+    auto match = m_generationOf.find(hash);
+    if (match != m_generationOf.end()) {
+        m_periodic = true;
+        m_cycleStart = match->second;
+        m_period = generation - match->second;
+        return true;
+    }
+    m_generationOf[hash] = generation;
+    m_history.emplace_back(generation, hash);
+    return false;
+}
+
+bool CycleDetector::isPeriodic() const {
+    return m_periodic;
+}
+
+uint64_t CycleDetector::getCycleStart() const {
+    return m_cycleStart;
+}
+
+uint64_t CycleDetector::getPeriod() const {
+    return m_period;
+}
+
+int CycleDetector::getMaxPeriod() const {
+    return m_maxPeriod;
+}
@@ -0,0 +1,578 @@
+#include "../include/Distributed.h"
+#include "../include/MappedFile.h"
+#include "../include/RandomFill.h"
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+static void closeSocket(int fd) {
+    if (fd >= 0)
+        ::close(fd);
+}
+
+static void sendAll(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::send(fd, p, bytes, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::runtime_error(std::string("Send to peer failed: ") + std::strerror(errno));
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+static void recvAll(int fd, void* data, size_t bytes) {
+    char* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::recv(fd, p, bytes, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::runtime_error("Peer closed the connection.");
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+static int connectTo(const std::string& host, int port, double timeoutSeconds) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || !addresses)
+        throw std::runtime_error("Cannot resolve host '" + host + "'.");
+
+    // The peer may not be listening yet; retry until the timeout
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeoutSeconds);
+    while (true) {
+        for (addrinfo* a = addresses; a; a = a->ai_next) {
+            int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd < 0)
+                continue;
+            if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+                freeaddrinfo(addresses);
+                return fd;
+            }
+            closeSocket(fd);
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            freeaddrinfo(addresses);
+            throw std::runtime_error("Cannot connect to " + host + ":" + std::to_string(port) + ".");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+#endif
+
+Communicator::Communicator(int rank, int size, const std::vector<std::string>& hosts, int basePort,
+                           double connectTimeoutSeconds)
+    : m_rank(rank), m_size(size), m_sockets(size, -1) {
+    if (size < 1 || rank < 0 || rank >= size)
+        throw std::runtime_error("Invalid rank " + std::to_string(rank) + " of " + std::to_string(size) + ".");
+#ifdef _WIN32
+    (void)hosts;
+    (void)basePort;
+    (void)connectTimeoutSeconds;
+    if (size > 1)
+        throw std::runtime_error("Distributed runs are only supported on POSIX systems.");
+#else
+    if (size == 1)
+        return;
+
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(basePort + rank));
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listener, size) != 0) {
+        closeSocket(listener);
+        throw std::runtime_error("Cannot listen on port " + std::to_string(basePort + rank) + ".");
+    }
+
+    try {
+        // Lower ranks are connected to, higher ranks connect to us; the
+        // listen backlog holds their connections until they are accepted
+        for (int peer = 0; peer < rank; ++peer) {
+            std::string host = hosts.empty() ? "127.0.0.1" : hosts[peer % hosts.size()];
+            int fd = connectTo(host, basePort + peer, connectTimeoutSeconds);
+            m_sockets[peer] = fd;
+            int32_t id = rank;
+            sendAll(fd, &id, sizeof(id));
+        }
+        for (int accepted = rank + 1; accepted < size; ++accepted) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0)
+                throw std::runtime_error("Accepting a peer connection failed.");
+            int32_t id = -1;
+            recvAll(fd, &id, sizeof(id));
+            if (id <= rank || id >= size || m_sockets[id] >= 0) {
+                closeSocket(fd);
+                throw std::runtime_error("Unexpected peer rank " + std::to_string(id) + ".");
+            }
+            m_sockets[id] = fd;
+        }
+    } catch (...) {
+        closeSocket(listener);
+        for (int fd : m_sockets)
+            closeSocket(fd);
+        throw;
+    }
+    closeSocket(listener);
+
+    for (int fd : m_sockets)
+        if (fd >= 0)
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+#endif
+}
+
+Communicator::~Communicator() {
+#ifndef _WIN32
+    for (int fd : m_sockets)
+        closeSocket(fd);
+#endif
+}
+
+int Communicator::rank() const {
+    return m_rank;
+}
+
+int Communicator::size() const {
+    return m_size;
+}
+
+void Communicator::exchange(const std::vector<Message>& sends, const std::vector<Message>& receives) {
+    // Per-peer queues, consumed in order. Empty messages are dropped: a
+    // receive that expects no bytes would never become readable.
+    std::vector<std::vector<Message>> sendQueues(m_size), receiveQueues(m_size);
+    for (const Message& m : sends)
+        if (m.bytes > 0)
+            sendQueues[m.peer].push_back(m);
+    for (const Message& m : receives)
+        if (m.bytes > 0)
+            receiveQueues[m.peer].push_back(m);
+
+    std::vector<Message>& selfSends = sendQueues[m_rank];
+    std::vector<Message>& selfReceives = receiveQueues[m_rank];
+    if (selfSends.size() != selfReceives.size())
+        throw std::runtime_error("Unmatched messages to the own rank.");
+    for (size_t i = 0; i < selfSends.size(); ++i) {
+        if (selfSends[i].bytes != selfReceives[i].bytes)
+            throw std::runtime_error("Message size mismatch on the own rank.");
+        std::memcpy(selfReceives[i].data, selfSends[i].data, selfSends[i].bytes);
+    }
+    selfSends.clear();
+    selfReceives.clear();
+
+#ifndef _WIN32
+    std::vector<size_t> sendIndex(m_size, 0), sendOffset(m_size, 0);
+    std::vector<size_t> receiveIndex(m_size, 0), receiveOffset(m_size, 0);
+    std::vector<pollfd> polls;
+    std::vector<int> pollPeers;
+    while (true) {
+        polls.clear();
+        pollPeers.clear();
+        for (int peer = 0; peer < m_size; ++peer) {
+            short events = 0;
+            if (sendIndex[peer] < sendQueues[peer].size())
+                events |= POLLOUT;
+            if (receiveIndex[peer] < receiveQueues[peer].size())
+                events |= POLLIN;
+            if (events) {
+                polls.push_back({ m_sockets[peer], events, 0 });
+                pollPeers.push_back(peer);
+            }
+        }
+        if (polls.empty())
+            return;
+        if (::poll(polls.data(), polls.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("poll() failed during a halo exchange.");
+        }
+
+        for (size_t i = 0; i < polls.size(); ++i) {
+            int peer = pollPeers[i];
+            int fd = polls[i].fd;
+            if (polls[i].revents & (POLLERR | POLLNVAL))
+                throw std::runtime_error("Connection to rank " + std::to_string(peer) + " failed.");
+            if (polls[i].revents & POLLOUT) {
+                const Message& m = sendQueues[peer][sendIndex[peer]];
+                ssize_t n = ::send(fd, static_cast<const char*>(m.data) + sendOffset[peer],
+                                   m.bytes - sendOffset[peer], MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    throw std::runtime_error("Send to rank " + std::to_string(peer) + " failed.");
+                if (n > 0)
+                    sendOffset[peer] += static_cast<size_t>(n);
+                if (sendOffset[peer] == m.bytes) {
+                    ++sendIndex[peer];
+                    sendOffset[peer] = 0;
+                }
+            }
+            if ((polls[i].revents & (POLLIN | POLLHUP)) && receiveIndex[peer] == receiveQueues[peer].size()) {
+                // POLLHUP is reported even when only POLLOUT was asked for;
+                // with nothing left to receive the peer is simply gone
+                throw std::runtime_error("Rank " + std::to_string(peer) + " closed the connection.");
+            }
+            if (polls[i].revents & (POLLIN | POLLHUP)) {
+                const Message& m = receiveQueues[peer][receiveIndex[peer]];
+                ssize_t n = ::recv(fd, static_cast<char*>(m.data) + receiveOffset[peer],
+                                   m.bytes - receiveOffset[peer], MSG_DONTWAIT);
+                if (n == 0)
+                    throw std::runtime_error("Rank " + std::to_string(peer) + " closed the connection.");
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    throw std::runtime_error("Receive from rank " + std::to_string(peer) + " failed.");
+                if (n > 0)
+                    receiveOffset[peer] += static_cast<size_t>(n);
+                if (receiveOffset[peer] == m.bytes) {
+                    ++receiveIndex[peer];
+                    receiveOffset[peer] = 0;
+                }
+            }
+        }
+    }
+#endif
+}
+
+uint64_t Communicator::allReduceSum(uint64_t value) {
+    // Reduced on rank 0 and sent back; the worlds only need a few of these
+    std::vector<uint64_t> values(m_size, 0);
+    std::vector<Message> sends, receives;
+    if (m_rank == 0) {
+        for (int peer = 1; peer < m_size; ++peer)
+            receives.push_back({ peer, &values[peer], sizeof(uint64_t) });
+        exchange(sends, receives);
+        for (int peer = 1; peer < m_size; ++peer)
+            value += values[peer];
+        receives.clear();
+        for (int peer = 1; peer < m_size; ++peer)
+            sends.push_back({ peer, &value, sizeof(uint64_t) });
+        exchange(sends, receives);
+    } else {
+        sends.push_back({ 0, &value, sizeof(uint64_t) });
+        exchange(sends, receives);
+        sends.clear();
+        receives.push_back({ 0, &value, sizeof(uint64_t) });
+        exchange(sends, receives);
+    }
+    return value;
+}
+
+void Communicator::barrier() {
+    allReduceSum(0);
+}
+
+BlockDecomposition BlockDecomposition::choose(size_t width, size_t height, int ranks) {
+    BlockDecomposition best = { width, height, ranks, 1 };
+    double bestHalo = -1.0;
+    for (int px = 1; px <= ranks; ++px) {
+        if (ranks % px != 0)
+            continue;
+        int py = ranks / px;
+        if (static_cast<size_t>(px) > width || static_cast<size_t>(py) > height)
+            continue;
+        double halo = static_cast<double>(width) / px + static_cast<double>(height) / py;
+        if (bestHalo < 0.0 || halo < bestHalo) {
+            bestHalo = halo;
+            best.px = px;
+            best.py = py;
+        }
+    }
+    if (bestHalo < 0.0)
+        throw std::runtime_error("The world is too small for " + std::to_string(ranks) + " ranks.");
+    return best;
+}
+
+size_t BlockDecomposition::columnBegin(int ix) const {
+    return width / px * ix + std::min<size_t>(ix, width % px);
+}
+
+size_t BlockDecomposition::rowBegin(int iy) const {
+    return height / py * iy + std::min<size_t>(iy, height % py);
+}
+
+size_t BlockDecomposition::blockWidth(int ix) const {
+    return columnBegin(ix + 1) - columnBegin(ix);
+}
+
+size_t BlockDecomposition::blockHeight(int iy) const {
+    return rowBegin(iy + 1) - rowBegin(iy);
+}
+
+DistributedLife::DistributedLife(Communicator& comm, size_t width, size_t height, int haloDepth)
+    : m_comm(comm), m_decomposition(BlockDecomposition::choose(width, height, comm.size())),
+      m_halo(std::max(1, haloDepth)), m_generation(0), m_exchangeSeconds(0.0), m_computeSeconds(0.0) {
+    m_ix = comm.rank() % m_decomposition.px;
+    m_iy = comm.rank() / m_decomposition.px;
+    m_x0 = m_decomposition.columnBegin(m_ix);
+    m_y0 = m_decomposition.rowBegin(m_iy);
+    m_blockWidth = m_decomposition.blockWidth(m_ix);
+    m_blockHeight = m_decomposition.blockHeight(m_iy);
+
+    // Ghost cells come from the adjacent blocks only, so the smallest block
+    // must cover the halo; the last blocks are the smallest
+    size_t halo = static_cast<size_t>(m_halo);
+    if (m_decomposition.blockWidth(m_decomposition.px - 1) < halo
+        || m_decomposition.blockHeight(m_decomposition.py - 1) < halo)
+        throw std::runtime_error("Blocks are narrower than the halo depth " + std::to_string(m_halo) + ".");
+
+    m_stride = m_blockWidth + 2 * halo;
+    m_current.assign(m_stride * (m_blockHeight + 2 * halo), 0);
+    m_next.assign(m_current.size(), 0);
+    for (int side = 0; side < 2; ++side) {
+        m_columnsOut[side].resize(m_blockHeight * halo);
+        m_columnsIn[side].resize(m_blockHeight * halo);
+    }
+}
+
+int DistributedLife::rankAt(int ix, int iy) const {
+    int px = m_decomposition.px, py = m_decomposition.py;
+    return ((iy + py) % py) * px + (ix + px) % px;
+}
+
+size_t DistributedLife::localIndex(size_t x, size_t y) const {
+    return y * m_stride + x;
+}
+
+void DistributedLife::randomize(double aliveProbability, uint64_t seed) {
+    // Keyed by the global cell index, so the world is the one
+    // GameOfLife::randomize() makes with the same seed, for any process grid
+    const size_t halo = static_cast<size_t>(m_halo);
+    const uint64_t threshold = aliveThreshold(aliveProbability);
+    for (size_t y = 0; y < m_blockHeight; ++y)
+        fillRandomCells(&m_current[localIndex(halo, y + halo)], (m_y0 + y) * m_decomposition.width + m_x0,
+                        m_blockWidth, seed, 0, threshold);
+    m_generation = 0;
+}
+
+void DistributedLife::loadFromFile(const std::string& filename) {
+    const size_t halo = static_cast<size_t>(m_halo);
+    MappedFile file;
+    WorldFileHeader header;
+    if (mapWorldFile(filename, file, header)) {
+        if (header.width != m_decomposition.width || header.height != m_decomposition.height)
+            throw std::runtime_error("World file dimensions do not match the distributed world.");
+        // Cell x of a row is bit x % 8 of byte x / 8 in the little-endian
+        // words. No rank reads the whole payload, so the checksum is not
+        // verified here.
+        const size_t rowBytes = (m_decomposition.width + 63) / 64 * 8;
+        const unsigned char* payload = file.data() + worldFileHeaderSize;
+        for (size_t y = 0; y < m_blockHeight; ++y) {
+            const unsigned char* row = payload + (m_y0 + y) * rowBytes;
+            for (size_t x = 0; x < m_blockWidth; ++x) {
+                size_t gx = m_x0 + x;
+                m_current[localIndex(x + halo, y + halo)] = (row[gx / 8] >> (gx % 8)) & 1;
+            }
+        }
+    } else {
+        std::vector<int> cells;
+        header = loadWorldFile(filename, cells);
+        if (header.states > 2)
+            throw std::runtime_error("Distributed worlds hold two states; the world file has " +
+                                     std::to_string(header.states) + ".");
+        if (header.width != m_decomposition.width || header.height != m_decomposition.height)
+            throw std::runtime_error("World file dimensions do not match the distributed world.");
+        for (size_t y = 0; y < m_blockHeight; ++y)
+            for (size_t x = 0; x < m_blockWidth; ++x)
+                m_current[localIndex(x + halo, y + halo)] =
+                    cells[(m_y0 + y) * m_decomposition.width + m_x0 + x] ? 1 : 0;
+    }
+    m_generation = static_cast<size_t>(header.generation);
+}
+
+void DistributedLife::exchangeHalos() {
+    const size_t halo = static_cast<size_t>(m_halo);
+    const int left = rankAt(m_ix - 1, m_iy), right = rankAt(m_ix + 1, m_iy);
+    const int up = rankAt(m_ix, m_iy - 1), down = rankAt(m_ix, m_iy + 1);
+
+    // Columns first, owned rows only: [0] = our first k columns, [1] = our last k
+    for (size_t y = 0; y < m_blockHeight; ++y) {
+        const uint8_t* row = &m_current[localIndex(0, y + halo)];
+        std::memcpy(&m_columnsOut[0][y * halo], row + halo, halo);
+        std::memcpy(&m_columnsOut[1][y * halo], row + m_blockWidth, halo);
+    }
+    // When left and right are the same rank the messages are matched in
+    // order: what we send left first is what that rank receives from its right
+    std::vector<Communicator::Message> sends = {
+        { left, m_columnsOut[0].data(), m_columnsOut[0].size() },
+        { right, m_columnsOut[1].data(), m_columnsOut[1].size() }
+    };
+    std::vector<Communicator::Message> receives = {
+        { right, m_columnsIn[1].data(), m_columnsIn[1].size() },
+        { left, m_columnsIn[0].data(), m_columnsIn[0].size() }
+    };
+    m_comm.exchange(sends, receives);
+    for (size_t y = 0; y < m_blockHeight; ++y) {
+        uint8_t* row = &m_current[localIndex(0, y + halo)];
+        std::memcpy(row, &m_columnsIn[0][y * halo], halo);
+        std::memcpy(row + halo + m_blockWidth, &m_columnsIn[1][y * halo], halo);
+    }
+
+    // Then whole rows including the ghost columns, which fills the corners.
+    // Rows are contiguous, so they go straight to and from the grid.
+    const size_t rowsBytes = halo * m_stride;
+    sends = {
+        { up, &m_current[localIndex(0, halo)], rowsBytes },
+        { down, &m_current[localIndex(0, m_blockHeight)], rowsBytes }
+    };
+    receives = {
+        { down, &m_current[localIndex(0, halo + m_blockHeight)], rowsBytes },
+        { up, &m_current[localIndex(0, 0)], rowsBytes }
+    };
+    m_comm.exchange(sends, receives);
+}
+
+void DistributedLife::step(size_t margin) {
+    // Computes the owned block plus margin ghost cells on every side
+    const size_t halo = static_cast<size_t>(m_halo);
+    const size_t x0 = halo - margin, x1 = halo + m_blockWidth + margin;
+    const size_t y0 = halo - margin, y1 = halo + m_blockHeight + margin;
+    for (size_t y = y0; y < y1; ++y) {
+        const uint8_t* above = &m_current[localIndex(0, y - 1)];
+        const uint8_t* row = &m_current[localIndex(0, y)];
+        const uint8_t* below = &m_current[localIndex(0, y + 1)];
+        uint8_t* out = &m_next[localIndex(0, y)];
+        for (size_t x = x0; x < x1; ++x) {
+            int neighbors = above[x - 1] + above[x] + above[x + 1] + row[x - 1] + row[x + 1]
+                          + below[x - 1] + below[x] + below[x + 1];
+            out[x] = (neighbors == 3 || (neighbors == 2 && row[x])) ? 1 : 0;
+        }
+    }
+    m_current.swap(m_next);
+}
+
+void DistributedLife::evolve(int generations) {
+    int done = 0;
+    while (done < generations) {
+        auto start = std::chrono::steady_clock::now();
+        exchangeHalos();
+        auto exchanged = std::chrono::steady_clock::now();
+        m_exchangeSeconds += std::chrono::duration<double>(exchanged - start).count();
+
+        int steps = std::min(m_halo, generations - done);
+        for (int s = 0; s < steps; ++s)
+            step(static_cast<size_t>(m_halo - 1 - s));
+        m_computeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - exchanged).count();
+        done += steps;
+    }
+    m_generation += static_cast<size_t>(generations > 0 ? generations : 0);
+}
+
+uint64_t DistributedLife::population() {
+    const size_t halo = static_cast<size_t>(m_halo);
+    uint64_t count = 0;
+    for (size_t y = 0; y < m_blockHeight; ++y) {
+        const uint8_t* row = &m_current[localIndex(halo, y + halo)];
+        count += static_cast<uint64_t>(std::count(row, row + m_blockWidth, 1));
+    }
+    return m_comm.allReduceSum(count);
+}
+
+std::vector<int> DistributedLife::ownedCells() const {
+    const size_t halo = static_cast<size_t>(m_halo);
+    std::vector<int> cells(m_blockWidth * m_blockHeight);
+    for (size_t y = 0; y < m_blockHeight; ++y)
+        for (size_t x = 0; x < m_blockWidth; ++x)
+            cells[y * m_blockWidth + x] = m_current[localIndex(x + halo, y + halo)];
+    return cells;
+}
+
+std::vector<int> DistributedLife::gather() {
+    const size_t halo = static_cast<size_t>(m_halo);
+    std::vector<Communicator::Message> sends, receives;
+    if (m_comm.rank() != 0) {
+        std::vector<uint8_t> block(m_blockWidth * m_blockHeight);
+        for (size_t y = 0; y < m_blockHeight; ++y)
+            std::memcpy(&block[y * m_blockWidth], &m_current[localIndex(halo, y + halo)], m_blockWidth);
+        sends.push_back({ 0, block.data(), block.size() });
+        m_comm.exchange(sends, receives);
+        return std::vector<int>();
+    }
+
+    const size_t width = m_decomposition.width;
+    std::vector<int> cells(width * m_decomposition.height, 0);
+    std::vector<std::vector<uint8_t>> blocks(m_comm.size());
+    for (int peer = 1; peer < m_comm.size(); ++peer) {
+        blocks[peer].resize(m_decomposition.blockWidth(peer % m_decomposition.px)
+                            * m_decomposition.blockHeight(peer / m_decomposition.px));
+        receives.push_back({ peer, blocks[peer].data(), blocks[peer].size() });
+    }
+    m_comm.exchange(sends, receives);
+
+    for (int r = 0; r < m_comm.size(); ++r) {
+        int ix = r % m_decomposition.px, iy = r / m_decomposition.px;
+        size_t bw = m_decomposition.blockWidth(ix), bh = m_decomposition.blockHeight(iy);
+        size_t x0 = m_decomposition.columnBegin(ix), y0 = m_decomposition.rowBegin(iy);
+        for (size_t y = 0; y < bh; ++y) {
+            const uint8_t* row = (r == 0) ? &m_current[localIndex(halo, y + halo)] : &blocks[r][y * bw];
+            std::copy(row, row + bw, cells.begin() + (y0 + y) * width + x0);
+        }
+    }
+    return cells;
+}
+
+void DistributedLife::saveGathered(const std::string& filename, WorldFileFormat format) {
+    std::vector<int> cells = gather();
+    if (m_comm.rank() == 0)
+        saveWorldFile(filename, cells, m_decomposition.width, m_decomposition.height, format, m_generation);
+    m_comm.barrier();
+}
+
+void DistributedLife::saveChunks(const std::string& filename) {
+    saveWorldFile(filename + "." + std::to_string(m_comm.rank()), ownedCells(), m_blockWidth, m_blockHeight,
+                  WorldFileFormat::Binary, m_generation);
+    if (m_comm.rank() == 0) {
+        std::ofstream manifest(filename);
+        if (!manifest)
+            throw std::runtime_error("Cannot open file '" + filename + "' for writing.");
+        // First line: world size, generation and block count; then one
+        // "x y width height file" line per rank
+        manifest << "GOL-CHUNKS " << m_decomposition.width << " " << m_decomposition.height << " "
+                 << m_generation << " " << m_comm.size() << "\n";
+        for (int r = 0; r < m_comm.size(); ++r) {
+            int ix = r % m_decomposition.px, iy = r / m_decomposition.px;
+            manifest << m_decomposition.columnBegin(ix) << " " << m_decomposition.rowBegin(iy) << " "
+                     << m_decomposition.blockWidth(ix) << " " << m_decomposition.blockHeight(iy) << " "
+                     << filename << "." << r << "\n";
+        }
+        if (!manifest)
+            throw std::runtime_error("Error writing file '" + filename + "'.");
+    }
+    m_comm.barrier();
+}
+
+const BlockDecomposition& DistributedLife::getDecomposition() const {
+    return m_decomposition;
+}
+
+size_t DistributedLife::getGeneration() const {
+    return m_generation;
+}
+
+double DistributedLife::getExchangeSeconds() const {
+    return m_exchangeSeconds;
+}
+
+double DistributedLife::getComputeSeconds() const {
+    return m_computeSeconds;
+}
@@ -1,15 +1,31 @@
 #include "../include/GameOfLife.h"
-#include <fstream>
+#include "../include/BitGrid.h"
+#include "../include/ThreadPool.h"
+#include "../include/HashLife.h"
+#include "../include/MappedFile.h"
+#include "../include/Pattern.h"
+#include "../include/ProgramCache.h"
+#include "../include/OpenCLDevice.h"
+#include "../include/MultiDevice.h"
+#include "../include/Rule.h"
+#include "../include/CycleDetector.h"
+#include "../include/RandomFill.h"
 #include <stdexcept>
 #include <cstdlib>
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <chrono>
 
 static const char *golKernelSource = R"CLC(
 #define INDEXFN(xx, yy, w) ((yy)*(w) + (xx))
 
-__kernel void evolveToroidal(__global const int* currentGrid,
-                             __global int* nextGrid,
+// CELL_T is the global cell type (int or uchar), set by the build options.
+// Local tiles always hold int cells. ALIVE and NEXT_STATE come from the rule
+// macros prepended to this source.
+
+__kernel void evolveToroidal(__global const CELL_T* currentGrid,
+                             __global CELL_T* nextGrid,
                              int width,
                              int height)
 {
@@ -23,61 +39,683 @@ __kernel void evolveToroidal(__global const int* currentGrid,
             if (dx == 0 && dy == 0) continue;
             int nx = (x + dx + width) % width;
             int ny = (y + dy + height) % height;
-            count += currentGrid[ INDEXFN(nx, ny, width) ];
+            count += ALIVE(currentGrid[ INDEXFN(nx, ny, width) ]);
         }
     }
 
     int currentState = currentGrid[ INDEXFN(x, y, width) ];
-    int nextState = 0;
-    if (currentState == 1) {
-        nextState = ((count == 2) || (count == 3)) ? 1 : 0;
-    } else {
-        nextState = (count == 3) ? 1 : 0;
+    int nextState = NEXT_STATE(currentState, count);
+    nextGrid[ INDEXFN(x, y, width) ] = (CELL_T)nextState;
+}
+
+// Tiled variant: each work-group stages its tile plus a one-cell halo in
+// local memory and each work-item computes TILED_ROWS_PER_ITEM cells of a
+// column. Toroidal wrap is only needed while loading the halo.
+__kernel void evolveToroidalTiled(__global const CELL_T* currentGrid,
+                                  __global CELL_T* nextGrid,
+                                  int width,
+                                  int height,
+                                  __local int* tile)
+{
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int groupW = get_local_size(0);
+    int groupH = get_local_size(1);
+    int tileX0 = get_group_id(0) * groupW;
+    int tileY0 = get_group_id(1) * groupH * TILED_ROWS_PER_ITEM;
+    int haloW = groupW + 2;
+    int haloCells = haloW * (groupH * TILED_ROWS_PER_ITEM + 2);
+
+    for (int i = ly * groupW + lx; i < haloCells; i += groupW * groupH) {
+        int gx = tileX0 + (i % haloW) - 1;
+        int gy = tileY0 + (i / haloW) - 1;
+        if (gx < 0 || gx >= width) gx = (gx % width + width) % width;
+        if (gy < 0 || gy >= height) gy = (gy % height + height) % height;
+        tile[i] = currentGrid[ INDEXFN(gx, gy, width) ];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int x = tileX0 + lx;
+    int y = tileY0 + ly * TILED_ROWS_PER_ITEM;
+    if (x >= width) return;
+
+    // Slide a 3x3 window down the column, reusing the rows already loaded
+    int c = (ly * TILED_ROWS_PER_ITEM + 1) * haloW + lx + 1;
+    int upSum = ALIVE(tile[c - haloW - 1]) + ALIVE(tile[c - haloW]) + ALIVE(tile[c - haloW + 1]);
+    int midLeft = ALIVE(tile[c - 1]);
+    int midState = tile[c];
+    int midRight = ALIVE(tile[c + 1]);
+    for (int r = 0; r < TILED_ROWS_PER_ITEM && y + r < height; r++) {
+        int downLeft = ALIVE(tile[c + haloW - 1]);
+        int downState = tile[c + haloW];
+        int downRight = ALIVE(tile[c + haloW + 1]);
+        int count = upSum + midLeft + midRight + downLeft + ALIVE(downState) + downRight;
+
+        int nextState = NEXT_STATE(midState, count);
+        nextGrid[ INDEXFN(x, y + r, width) ] = (CELL_T)nextState;
+
+        upSum = midLeft + ALIVE(midState) + midRight;
+        midLeft = downLeft;
+        midState = downState;
+        midRight = downRight;
+        c += haloW;
+    }
+}
+
+// Temporally blocked variant: each work-group loads its tile plus a
+// depth-wide halo and advances it depth generations in local memory,
+// ping-ponging between regionA and regionB. The valid area shrinks by one
+// cell per generation, so after depth steps exactly the tile is correct.
+__kernel void evolveToroidalBlocked(__global const CELL_T* currentGrid,
+                                    __global CELL_T* nextGrid,
+                                    int width,
+                                    int height,
+                                    int depth,
+                                    __local int* regionA,
+                                    __local int* regionB)
+{
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int groupW = get_local_size(0);
+    int groupH = get_local_size(1);
+    int localItems = groupW * groupH;
+    int tileX0 = get_group_id(0) * groupW;
+    int tileY0 = get_group_id(1) * groupH;
+    int regionW = groupW + 2 * depth;
+    int regionH = groupH + 2 * depth;
+    int regionCells = regionW * regionH;
+
+    for (int i = ly * groupW + lx; i < regionCells; i += localItems) {
+        int gx = tileX0 + (i % regionW) - depth;
+        int gy = tileY0 + (i / regionW) - depth;
+        if (gx < 0 || gx >= width) gx = (gx % width + width) % width;
+        if (gy < 0 || gy >= height) gy = (gy % height + height) % height;
+        regionA[i] = currentGrid[ INDEXFN(gx, gy, width) ];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    __local int* src = regionA;
+    __local int* dst = regionB;
+    for (int step = 1; step <= depth; step++) {
+        int innerW = regionW - 2 * step;
+        int innerCells = innerW * (regionH - 2 * step);
+        for (int i = ly * groupW + lx; i < innerCells; i += localItems) {
+            int c = (step + i / innerW) * regionW + step + i % innerW;
+            int count = ALIVE(src[c - regionW - 1]) + ALIVE(src[c - regionW]) + ALIVE(src[c - regionW + 1])
+                      + ALIVE(src[c - 1]) + ALIVE(src[c + 1])
+                      + ALIVE(src[c + regionW - 1]) + ALIVE(src[c + regionW]) + ALIVE(src[c + regionW + 1]);
+            dst[c] = NEXT_STATE(src[c], count);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        __local int* swap = src;
+        src = dst;
+        dst = swap;
     }
-    nextGrid[ INDEXFN(x, y, width) ] = nextState;
+
+    int x = tileX0 + lx;
+    int y = tileY0 + ly;
+    if (x < width && y < height)
+        nextGrid[ INDEXFN(x, y, width) ] = (CELL_T)src[(ly + depth) * regionW + lx + depth];
 }
+
+// Horizontal neighbours of word i in a packed row, with toroidal wrap.
+// west holds cell x-1 at bit x, east holds cell x+1 at bit x.
+inline void horizontalNeighbors(__global const ulong* row, int i, int wordsPerRow, int lastBit,
+                                ulong* west, ulong* east)
+{
+    ulong word = row[i];
+    ulong carryIn = (i > 0) ? (row[i - 1] >> 63) : ((row[wordsPerRow - 1] >> lastBit) & 1UL);
+    ulong carryOut = (i + 1 < wordsPerRow) ? (row[i + 1] << 63) : ((row[0] & 1UL) << lastBit);
+    *west = (word << 1) | carryIn;
+    *east = (word >> 1) | carryOut;
+}
+
+// Bit-packed variant in BitGrid's layout: cell x of a row is bit x % 64 of
+// word x / 64 and the padding bits of the last word stay zero. Each
+// work-item computes one word with bitwise full adders.
+__kernel void evolveBitPacked(__global const ulong* currentWords,
+                              __global ulong* nextWords,
+                              int width,
+                              int height)
+{
+    int i = get_global_id(0);
+    int y = get_global_id(1);
+    int wordsPerRow = (width + 63) / 64;
+    int lastBit = (width - 1) % 64;
+    __global const ulong* up = currentWords + ((y + height - 1) % height) * wordsPerRow;
+    __global const ulong* mid = currentWords + y * wordsPerRow;
+    __global const ulong* down = currentWords + ((y + 1) % height) * wordsPerRow;
+
+    ulong upWest, upEast, midWest, midEast, downWest, downEast;
+    horizontalNeighbors(up, i, wordsPerRow, lastBit, &upWest, &upEast);
+    horizontalNeighbors(mid, i, wordsPerRow, lastBit, &midWest, &midEast);
+    horizontalNeighbors(down, i, wordsPerRow, lastBit, &downWest, &downEast);
+
+    // Full adders per row: each row contributes sum + 2 * carry neighbours
+    ulong upSum = upWest ^ up[i] ^ upEast;
+    ulong upCarry = (upWest & up[i]) | (upEast & (upWest ^ up[i]));
+    ulong midSum = midWest ^ midEast;
+    ulong midCarry = midWest & midEast;
+    ulong downSum = downWest ^ down[i] ^ downEast;
+    ulong downCarry = (downWest & down[i]) | (downEast & (downWest ^ down[i]));
+
+    // Combine the three row sums into ones + 2 * carry
+    ulong ones = upSum ^ midSum ^ downSum;
+    ulong onesCarry = (upSum & midSum) | (downSum & (upSum ^ midSum));
+
+    ulong pairA = upCarry ^ midCarry;
+    ulong bothA = upCarry & midCarry;
+    ulong pairB = downCarry ^ onesCarry;
+    ulong bothB = downCarry & onesCarry;
+#ifdef RULE_CONWAY
+    // Neighbour count is 2 or 3 exactly when one of the four weight-2 bits is set
+    ulong twoOrThree = (pairA ^ pairB) & ~(bothA | bothB);
+    ulong next = twoOrThree & (ones | mid[i]);
+#else
+    // Other two-state rules: sum the four weight-2 bits into the count bit
+    // planes and OR the count masks of the rule; the loop unrolls and the
+    // counts outside the rule drop out at compile time
+    ulong carry = pairA & pairB;
+    ulong twos = pairA ^ pairB;
+    ulong fours = bothA ^ bothB ^ carry;
+    ulong eights = (bothA & bothB) | (carry & (bothA ^ bothB));
+    ulong next = 0;
+    for (int n = 0; n <= 8; n++) {
+        ulong count = ((n & 1) ? ones : ~ones) & ((n & 2) ? twos : ~twos)
+                    & ((n & 4) ? fours : ~fours) & ((n & 8) ? eights : ~eights);
+        if (BORN(n))
+            next |= count & ~mid[i];
+        if (SURVIVES(n))
+            next |= count & mid[i];
+    }
+#endif
+    if (i + 1 == wordsPerRow && (width % 64) != 0)
+        next &= (1UL << (width % 64)) - 1UL;
+    nextWords[y * wordsPerRow + i] = next;
+}
+
+// Grid hash for cycle detection, the same function as cellHash() on the
+// host. Each work-group sums the hashes of a strided share of the cells
+// and writes its partial sum to hashes[slot * groups + group].
+inline ulong cellHash(ulong index, int state)
+{
+    ulong z = ((index << 8) | (ulong)state) * 0x9E3779B97F4A7C15UL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+    return state ? z ^ (z >> 31) : 0UL;
+}
+
+// Tree reduction over a power-of-two work-group
+inline void storeGroupSum(ulong sum, __local ulong* partial, __global ulong* hashes, int slot)
+{
+    int lid = get_local_id(0);
+    partial[lid] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int offset = get_local_size(0) / 2; offset > 0; offset /= 2) {
+        if (lid < offset)
+            partial[lid] += partial[lid + offset];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (lid == 0)
+        hashes[slot * get_num_groups(0) + get_group_id(0)] = partial[0];
+}
+
+__kernel void hashCells(__global const CELL_T* grid,
+                        ulong cells,
+                        __global ulong* hashes,
+                        int slot,
+                        __local ulong* partial)
+{
+    ulong sum = 0;
+    for (ulong i = get_global_id(0); i < cells; i += get_global_size(0))
+        sum += cellHash(i, grid[i]);
+    storeGroupSum(sum, partial, hashes, slot);
+}
+
+// Bit-packed storage: only set bits contribute, in BitGrid's layout
+__kernel void hashWords(__global const ulong* words,
+                        int width,
+                        int height,
+                        __global ulong* hashes,
+                        int slot,
+                        __local ulong* partial)
+{
+    int wordsPerRow = (width + 63) / 64;
+    ulong wordCount = (ulong)wordsPerRow * height;
+    ulong sum = 0;
+    for (ulong w = get_global_id(0); w < wordCount; w += get_global_size(0)) {
+        ulong rowStart = (w / wordsPerRow) * width + (w % wordsPerRow) * 64;
+        ulong bits = words[w];
+        while (bits) {
+            ulong lowest = bits & (~bits + 1UL);
+            sum += cellHash(rowStart + 63 - clz(lowest), 1);
+            bits ^= lowest;
+        }
+    }
+    storeGroupSum(sum, partial, hashes, slot);
+}
+
+// Philox4x32-10 block for a counter, stream and key, as philox4x32() in
+// RandomFill.h
+inline uint4 philox4x32(ulong counter, ulong stream, ulong key)
+{
+    uint4 c = (uint4)((uint)counter, (uint)(counter >> 32), (uint)stream, (uint)(stream >> 32));
+    uint k0 = (uint)key;
+    uint k1 = (uint)(key >> 32);
+    for (int round = 0; round < 10; ++round) {
+        uint hi0 = mul_hi(0xD2511F53u, c.x);
+        uint lo0 = 0xD2511F53u * c.x;
+        uint hi1 = mul_hi(0xCD9E8D57u, c.z);
+        uint lo1 = 0xCD9E8D57u * c.z;
+        c = (uint4)(hi1 ^ c.y ^ k0, lo1, hi0 ^ c.w ^ k1, lo0);
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    return c;
+}
+
+// Random fill, four cells per work-item: cell i is alive if word i % 4 of
+// the block for counter i / 4 is below threshold
+__kernel void randomCells(__global CELL_T* grid,
+                          ulong cells,
+                          ulong seed,
+                          ulong threshold)
+{
+    ulong first = (ulong)get_global_id(0) * 4;
+    uint4 block = philox4x32(first / 4, 0, seed);
+    uint words[4] = { block.x, block.y, block.z, block.w };
+    for (int lane = 0; lane < 4 && first + lane < cells; ++lane)
+        grid[first + lane] = (CELL_T)(words[lane] < threshold);
+}
+
+// Bit-packed storage: one word per work-item; rows need not start on a
+// block boundary
+__kernel void randomWords(__global ulong* words,
+                          int width,
+                          int height,
+                          ulong seed,
+                          ulong threshold)
+{
+    int i = get_global_id(0);
+    int y = get_global_id(1);
+    int wordsPerRow = (width + 63) / 64;
+    int begin = i * 64;
+    int end = min(begin + 64, width);
+    ulong rowStart = (ulong)y * width;
+    ulong bits = 0;
+    uint block[4];
+    for (int x = begin; x < end; ++x) {
+        ulong index = rowStart + x;
+        if (x == begin || index % 4 == 0) {
+            uint4 b = philox4x32(index / 4, 0, seed);
+            block[0] = b.x; block[1] = b.y; block[2] = b.z; block[3] = b.w;
+        }
+        if (block[index % 4] < threshold)
+            bits |= 1UL << (x - begin);
+    }
+    words[y * wordsPerRow + i] = bits;
+}
+
+#ifdef RULE_RANGE
+// Larger than Life: counts every cell within RULE_RANGE, in a square or
+// (RULE_VON_NEUMANN) diamond neighbourhood
+__kernel void evolveLargerThanLife(__global const CELL_T* currentGrid,
+                                   __global CELL_T* nextGrid,
+                                   int width,
+                                   int height)
+{
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    int count = 0;
+    for (int dy = -RULE_RANGE; dy <= RULE_RANGE; dy++) {
+        int ny = ((y + dy) % height + height) % height;
+        int reach = RULE_VON_NEUMANN ? RULE_RANGE - abs(dy) : RULE_RANGE;
+        for (int dx = -reach; dx <= reach; dx++) {
+            int nx = ((x + dx) % width + width) % width;
+            count += ALIVE(currentGrid[ INDEXFN(nx, ny, width) ]);
+        }
+    }
+
+    int currentState = currentGrid[ INDEXFN(x, y, width) ];
+    if (!RULE_COUNT_CENTER)
+        count -= ALIVE(currentState);
+    nextGrid[ INDEXFN(x, y, width) ] = (CELL_T)NEXT_STATE(currentState, count);
+}
+#endif
 )CLC";
 
+// Cells computed per work-item by evolveToroidalTiled
+static const int tiledRowsPerItem = 4;
+
+// Kernel events held back while profiling before the oldest half is read
+static const size_t maxPendingProfileEvents = 1024;
+// Generations of grid hashes read back at once in hashed OpenCL runs
+static const size_t hashBatchGenerations = 64;
+
+// Appends the execution time of a finished command to samples
+static void recordEventTime(cl_event event, std::vector<double>& samples) {
+    cl_ulong start = 0, end = 0;
+    if (clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start, nullptr) != CL_SUCCESS
+        || clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &end, nullptr) != CL_SUCCESS)
+        return;
+    samples.push_back(static_cast<double>(end - start) * 1e-6);
+}
+
+// Waits for the oldest count kernel events, records and releases them
+static void collectKernelEvents(std::vector<cl_event>& events, size_t count, std::vector<double>& samples) {
+    if (count == 0)
+        return;
+    clWaitForEvents(1, &events[count - 1]);
+    for (size_t i = 0; i < count; ++i) {
+        recordEventTime(events[i], samples);
+        clReleaseEvent(events[i]);
+    }
+    events.erase(events.begin(), events.begin() + count);
+}
+
+static GameOfLife::PhaseStats summarizeSamples(std::vector<double> samples) {
+    GameOfLife::PhaseStats stats;
+    if (samples.empty())
+        return stats;
+    std::sort(samples.begin(), samples.end());
+    stats.count = samples.size();
+    for (double sample : samples)
+        stats.totalMs += sample;
+    stats.meanMs = stats.totalMs / stats.count;
+    // Nearest-rank percentile
+    size_t rank = (99 * stats.count + 99) / 100;
+    stats.p99Ms = samples[rank - 1];
+    return stats;
+}
+
+// Converts the int host grid to the layout of the device buffers. UChar
+// uses one byte per cell, BitPacked BitGrid's word layout.
+static void packDeviceCells(GameOfLife::CellStorage storage, const std::vector<int>& cells,
+                            size_t width, size_t height, std::vector<unsigned char>& out)
+{
+    if (storage == GameOfLife::CellStorage::UChar) {
+        // Bytes hold every state of a Generations rule (at most 256)
+        out.resize(width * height);
+        for (size_t i = 0; i < out.size(); ++i)
+            out[i] = static_cast<unsigned char>(cells[i]);
+        return;
+    }
+    size_t wordsPerRow = (width + 63) / 64;
+    out.resize(sizeof(uint64_t) * wordsPerRow * height);
+    uint64_t* words = reinterpret_cast<uint64_t*>(out.data());
+    for (size_t y = 0; y < height; ++y) {
+        const int* row = cells.data() + y * width;
+        for (size_t i = 0; i < wordsPerRow; ++i) {
+            size_t begin = i * 64;
+            size_t end = std::min(begin + 64, width);
+            uint64_t word = 0;
+            for (size_t x = begin; x < end; ++x) {
+                if (row[x] != 0)
+                    word |= uint64_t(1) << (x - begin);
+            }
+            words[y * wordsPerRow + i] = word;
+        }
+    }
+}
+
+static void unpackDeviceCells(GameOfLife::CellStorage storage, const std::vector<unsigned char>& data,
+                              size_t width, size_t height, int* cells)
+{
+    if (storage == GameOfLife::CellStorage::UChar) {
+        for (size_t i = 0; i < width * height; ++i)
+            cells[i] = data[i];
+        return;
+    }
+    size_t wordsPerRow = (width + 63) / 64;
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(data.data());
+    for (size_t y = 0; y < height; ++y) {
+        const uint64_t* row = words + y * wordsPerRow;
+        int* out = cells + y * width;
+        for (size_t x = 0; x < width; ++x)
+            out[x] = static_cast<int>((row[x / 64] >> (x % 64)) & 1u);
+    }
+}
+
+// Next-state functions for evolveRegion(). Conway's rule and a few common
+// life-like rules are compile-time constants, so their instantiations
+// carry no rule lookups; other rules read their masks at run time. alive()
+// is what a neighbour in a given state adds to the count.
+struct ConwayRule {
+    static int alive(int state) { return state; }
+    int operator()(int state, int neighbors) const {
+        if (state == 1)
+            return (neighbors == 2 || neighbors == 3) ? 1 : 0;
+        return (neighbors == 3) ? 1 : 0;
+    }
+};
+
+template <uint32_t Birth, uint32_t Survival>
+struct FixedLifeLikeRule {
+    static int alive(int state) { return state; }
+    int operator()(int state, int neighbors) const {
+        return static_cast<int>(((state ? Survival : Birth) >> neighbors) & 1u);
+    }
+};
+
+struct MaskRule {
+    uint32_t birth;
+    uint32_t survival;
+    static int alive(int state) { return state; }
+    int operator()(int state, int neighbors) const {
+        return static_cast<int>(((state ? survival : birth) >> neighbors) & 1u);
+    }
+};
+
+struct GenerationsRule {
+    uint32_t birth;
+    uint32_t survival;
+    int states;
+    static int alive(int state) { return state == 1 ? 1 : 0; }
+    int operator()(int state, int neighbors) const {
+        if (state == 0)
+            return static_cast<int>((birth >> neighbors) & 1u);
+        if (state == 1)
+            return ((survival >> neighbors) & 1u) ? 1 : 2;
+        return (state + 1 < states) ? state + 1 : 0;
+    }
+};
+
+// Computes the cells in columns [x0, x1) of rows [y0, y1) of the next
+// generation and reports whether any of them changed. Neighbor columns and
+// rows wrap only at the edges, so the inner loop has no modulo.
+template <class RuleT>
+static bool evolveRegion(const RuleT& rule, const int* current, int* next, size_t width, size_t height,
+                         size_t x0, size_t x1, size_t y0, size_t y1)
+{
+    int changed = 0;
+    for (size_t y = y0; y < y1; ++y) {
+        const int* up = current + ((y + height - 1) % height) * width;
+        const int* mid = current + y * width;
+        const int* down = current + ((y + 1) % height) * width;
+        int* out = next + y * width;
+        for (size_t x = x0; x < x1; ++x) {
+            size_t left = (x == 0) ? width - 1 : x - 1;
+            size_t right = (x + 1 == width) ? 0 : x + 1;
+            int neighbors = RuleT::alive(up[left]) + RuleT::alive(up[x]) + RuleT::alive(up[right])
+                          + RuleT::alive(mid[left]) + RuleT::alive(mid[right])
+                          + RuleT::alive(down[left]) + RuleT::alive(down[x]) + RuleT::alive(down[right]);
+            int nextState = rule(mid[x], neighbors);
+            changed |= nextState ^ mid[x];
+            out[x] = nextState;
+        }
+    }
+    return changed != 0;
+}
+
+// Larger than Life version of evolveRegion(). Square neighbourhoods slide a
+// window of per-column sums along each row, so a cell costs O(range) rather
+// than O(range^2); diamonds are summed directly.
+static bool evolveLargerThanLifeRegion(const Rule& rule, const int* current, int* next, size_t width, size_t height,
+                                       size_t x0, size_t x1, size_t y0, size_t y1)
+{
+    const long long r = rule.range;
+    const long long w = static_cast<long long>(width);
+    const long long h = static_cast<long long>(height);
+    auto alive = [&](long long x, long long y) {
+        return current[static_cast<size_t>(((y % h + h) % h) * w + (x % w + w) % w)] == 1 ? 1 : 0;
+    };
+
+    int changed = 0;
+    std::vector<int> columns(x1 - x0 + 2 * static_cast<size_t>(r));
+    for (size_t y = y0; y < y1; ++y) {
+        const long long cy = static_cast<long long>(y);
+        if (!rule.vonNeumann) {
+            for (size_t i = 0; i < columns.size(); ++i) {
+                long long cx = static_cast<long long>(x0 + i) - r;
+                int sum = 0;
+                for (long long dy = -r; dy <= r; ++dy)
+                    sum += alive(cx, cy + dy);
+                columns[i] = sum;
+            }
+        }
+        int window = 0;
+        for (size_t x = x0; x < x1; ++x) {
+            const long long cx = static_cast<long long>(x);
+            int count = 0;
+            if (rule.vonNeumann) {
+                for (long long dy = -r; dy <= r; ++dy) {
+                    long long reach = r - (dy < 0 ? -dy : dy);
+                    for (long long dx = -reach; dx <= reach; ++dx)
+                        count += alive(cx + dx, cy + dy);
+                }
+            } else {
+                size_t i = x - x0;
+                if (x == x0) {
+                    for (size_t k = 0; k < static_cast<size_t>(2 * r + 1); ++k)
+                        window += columns[k];
+                } else {
+                    window += columns[i + 2 * static_cast<size_t>(r)] - columns[i - 1];
+                }
+                count = window;
+            }
+
+            int state = current[y * width + x];
+            if (!rule.countCenter)
+                count -= (state == 1) ? 1 : 0;
+            int nextState = 0;
+            if (state == 0)
+                nextState = rule.born(count) ? 1 : 0;
+            else if (state == 1)
+                nextState = rule.survives(count) ? 1 : (rule.states > 2 ? 2 : 0);
+            else
+                nextState = (state + 1 < rule.states) ? state + 1 : 0;
+            changed |= nextState ^ state;
+            next[y * width + x] = nextState;
+        }
+    }
+    return changed != 0;
+}
+
+// Picks the evolveRegion() instantiation for a rule
+static bool evolveRuleRegion(const Rule& rule, const int* current, int* next, size_t width, size_t height,
+                             size_t x0, size_t x1, size_t y0, size_t y1)
+{
+    if (rule.isLargerThanLife())
+        return evolveLargerThanLifeRegion(rule, current, next, width, height, x0, x1, y0, y1);
+    if (rule.states > 2)
+        return evolveRegion(GenerationsRule{ rule.birth, rule.survival, rule.states },
+                            current, next, width, height, x0, x1, y0, y1);
+    if (rule.isConway())
+        return evolveRegion(ConwayRule(), current, next, width, height, x0, x1, y0, y1);
+    if (rule.birth == 0x48 && rule.survival == 0xC)     // HighLife, B36/S23
+        return evolveRegion(FixedLifeLikeRule<0x48, 0xC>(), current, next, width, height, x0, x1, y0, y1);
+    if (rule.birth == 0x1C8 && rule.survival == 0x1D8)  // Day & Night, B3678/S34678
+        return evolveRegion(FixedLifeLikeRule<0x1C8, 0x1D8>(), current, next, width, height, x0, x1, y0, y1);
+    if (rule.birth == 0x4 && rule.survival == 0)        // Seeds, B2/S
+        return evolveRegion(FixedLifeLikeRule<0x4, 0>(), current, next, width, height, x0, x1, y0, y1);
+    return evolveRegion(MaskRule{ rule.birth, rule.survival }, current, next, width, height, x0, x1, y0, y1);
+}
+
+// Edge length of the square tiles tracked by evolveSparse()
+static const size_t sparseTileSize = 32;
+
 GameOfLife::GameOfLife(size_t width, size_t height)
-    : m_width(width), m_height(height), openclInitialized(false)
+    : m_width(width), m_height(height), m_mappedHeader(), openclInitialized(false),
+      m_kernelVariant(KernelVariant::Naive), m_blockDepth(4),
+      m_cellStorage(CellStorage::Int), m_hostStale(false), m_deviceStale(true),
+      m_profiling(false), m_sparseValid(false), m_hashLifeValid(false)
 {
     m_currentGrid.resize(m_width * m_height, 0);
     m_nextGrid.resize(m_width * m_height, 0);
 
     context = nullptr;
     queue = nullptr;
+    transferQueue = nullptr;
     program = nullptr;
-    kernel = nullptr;
-    currentBuffer = nullptr;
-    nextBuffer = nullptr;
+    kernels[0] = kernels[1] = nullptr;
+    gridBuffers[0] = gridBuffers[1] = nullptr;
+    currentBufferIndex = 0;
+    hashKernel = nullptr;
+    hashBuffer = nullptr;
+    hashGroups = hashGroupSize = 0;
+    localWorkSize[0] = localWorkSize[1] = 0;
     device = nullptr;
+    m_gridHash = 0;
+    m_hashValid = false;
+    m_simdIsa = SimdLife::bestIsa();
+    m_generation = 0;
 }
 
-GameOfLife::GameOfLife(const std::string &filename) {
-    std::ifstream infile(filename);
-    if (!infile.is_open())
-        throw std::runtime_error("Failed to open file: " + filename);
-    
-    if (!(infile >> m_width >> m_height))
-        throw std::runtime_error("Invalid file format: width and height not found.");
-    
-    if (m_width == 0 || m_height == 0)
-        throw std::runtime_error("Invalid dimensions in file: width and height must be > 0.");
-    
-    m_currentGrid.resize(m_width * m_height, 0);
-    m_nextGrid.resize(m_width * m_height, 0);
-    
-    for (size_t i = 0; i < m_width * m_height; ++i) {
-        int cellValue = 0;
-        if (!(infile >> cellValue))
-            throw std::runtime_error("Not enough cell values in file. Expected " +
-                                     std::to_string(m_width * m_height) + " values.");
-        m_currentGrid[i] = cellValue;
+// The rule a world file was saved under. Files without one (text, and
+// binary files written before the rule was stored) keep only their state
+// count: dying states then survive a setRule() with as many states and are
+// cleared by one with fewer.
+static Rule storedRule(const WorldFileHeader& header, Rule rule) {
+    if (header.rule.empty()) {
+        if (header.states > 2)
+            rule.states = header.states;
+        return rule;
+    }
+    try {
+        rule = parseRule(header.rule);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string("Invalid rule in world file: ") + e.what());
     }
-    infile.close();
+    if (rule.states != header.states)
+        throw std::runtime_error("World file rule " + header.rule + " does not match its " +
+                                 std::to_string(header.states) + " cell states.");
+    return rule;
+}
+
+GameOfLife::GameOfLife(const std::string &filename, bool memoryMap)
+    : m_mappedHeader(), context(nullptr), queue(nullptr), transferQueue(nullptr), program(nullptr),
+      kernels{nullptr, nullptr}, gridBuffers{nullptr, nullptr}, currentBufferIndex(0),
+      hashKernel(nullptr), hashBuffer(nullptr), hashGroups(0), hashGroupSize(0), device(nullptr),
+      openclInitialized(false), localWorkSize{0, 0}, m_kernelVariant(KernelVariant::Naive), m_blockDepth(4),
+      m_cellStorage(CellStorage::Int), m_hostStale(false), m_deviceStale(true), m_profiling(false), m_sparseValid(false),
+      m_gridHash(0), m_hashValid(false), m_simdIsa(SimdLife::bestIsa()), m_generation(0), m_hashLifeValid(false)
+{
+    if (memoryMap) {
+        std::unique_ptr<MappedFile> mapped(new MappedFile());
+        if (mapWorldFile(filename, *mapped, m_mappedHeader)) {
+            m_width = static_cast<size_t>(m_mappedHeader.width);
+            m_height = static_cast<size_t>(m_mappedHeader.height);
+            m_generation = m_mappedHeader.generation;
+            m_rule = storedRule(m_mappedHeader, m_rule);
+            m_mappedWorld = std::move(mapped);
+            return;
+        }
+    }
+
+    WorldFileHeader header = loadWorldFile(filename, m_currentGrid);
+    m_width = static_cast<size_t>(header.width);
+    m_height = static_cast<size_t>(header.height);
+    m_generation = header.generation;
+    m_nextGrid.resize(m_width * m_height, 0);
+    m_rule = storedRule(header, m_rule);
 }
 
 GameOfLife::~GameOfLife() {
+    // Nothing is read back or unpacked: a mapped world or resident bit grid
+    // is simply released with its member
+    m_hostStale = false;
     cleanupOpenCL();
 }
 
@@ -96,7 +734,34 @@ int GameOfLife::countNeighbors(size_t x, size_t y) const {
     return count;
 }
 
+// Change of the grid hash between two generations of cells [begin, end)
+static uint64_t hashDelta(const int* before, const int* after, size_t begin, size_t end) {
+    uint64_t delta = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (before[i] != after[i])
+            delta += cellHash(i, after[i]) - cellHash(i, before[i]);
+    }
+    return delta;
+}
+
 void GameOfLife::evolveScalar() {
+    syncHostGrid();
+    // A valid hash is updated from the cells that changed, row by row while
+    // both generations of the row are still in cache
+    bool trackHash = m_hashValid;
+    if (!m_rule.isConway()) {
+        for (size_t y = 0; y < m_height; ++y) {
+            bool changed = evolveRuleRegion(m_rule, m_currentGrid.data(), m_nextGrid.data(),
+                                            m_width, m_height, 0, m_width, y, y + 1);
+            if (trackHash && changed)
+                m_gridHash += hashDelta(m_currentGrid.data(), m_nextGrid.data(), y * m_width, (y + 1) * m_width);
+        }
+        m_currentGrid.swap(m_nextGrid);
+        markHostModified();
+        m_hashValid = trackHash;
+        ++m_generation;
+        return;
+    }
     for (size_t y = 0; y < m_height; ++y) {
         for (size_t x = 0; x < m_width; ++x) {
             int neighbors = countNeighbors(x, y);
@@ -107,38 +772,384 @@ void GameOfLife::evolveScalar() {
             else
                 nextState = (neighbors == 3) ? 1 : 0;
             m_nextGrid[cellIndex(x, y)] = nextState;
+            if (trackHash && nextState != currentState)
+                m_gridHash += cellHash(cellIndex(x, y), nextState) - cellHash(cellIndex(x, y), currentState);
         }
     }
     m_currentGrid.swap(m_nextGrid);
+    markHostModified();
+    m_hashValid = trackHash;
+    ++m_generation;
+}
+
+void GameOfLife::evolveBitPacked(int generations) {
+    // Multi-state and Larger than Life rules do not fit one bit per cell
+    if (!m_rule.isLifeLike()) {
+        for (int g = 0; g < generations; ++g)
+            evolveScalar();
+        return;
+    }
+    // The BitGrid stays the world's storage between calls; the int grids
+    // (32x larger) are freed until the host needs cells again
+    if (!m_bitGrid) {
+        std::unique_ptr<BitGrid> packed(new BitGrid(m_width, m_height));
+        if (m_mappedWorld) {
+            // The mapped payload already has BitGrid's layout, so it is
+            // loaded directly and the int grid is never allocated
+            verifyMappedWorld(*m_mappedWorld, m_mappedHeader);
+            packed->loadWords(m_mappedWorld->data() + worldFileHeaderSize);
+            m_mappedWorld.reset();
+        } else {
+            syncHostGrid();
+            packed->pack(m_currentGrid);
+        }
+        m_bitGrid = std::move(packed);
+        std::vector<int>().swap(m_currentGrid);
+        std::vector<int>().swap(m_nextGrid);
+    }
+    m_bitGrid->setRule(m_rule.birth, m_rule.survival);
+    m_bitGrid->evolve(generations);
+    markHostModified();
+    m_generation += generations;
+}
+
+void GameOfLife::evolveSimd(int generations) {
+    if (!m_rule.isLifeLike()) {
+        for (int g = 0; g < generations; ++g)
+            evolveScalar();
+        return;
+    }
+    // Like the BitGrid in evolveBitPacked(), the byte grid stays the
+    // world's storage between calls and the int grids are freed meanwhile
+    if (!m_simdGrid) {
+        syncHostGrid();
+        std::unique_ptr<SimdLife> bytes(new SimdLife(m_width, m_height));
+        bytes->pack(m_currentGrid);
+        m_simdGrid = std::move(bytes);
+        std::vector<int>().swap(m_currentGrid);
+        std::vector<int>().swap(m_nextGrid);
+    }
+    m_simdGrid->setRule(m_rule.birth, m_rule.survival);
+    m_simdGrid->setIsa(m_simdIsa);
+    m_simdGrid->evolve(generations);
+    markHostModified();
+    m_generation += generations;
+}
+
+void GameOfLife::evolveThreaded(int generations, unsigned threadCount) {
+    if (generations <= 0)
+        return;
+    syncHostGrid();
+    if (!m_threadPool || (threadCount != 0 && m_threadPool->size() != threadCount))
+        m_threadPool.reset(new ThreadPool(threadCount));
+
+    const unsigned workers = m_threadPool->size();
+    Barrier barrier(workers);
+    int* buffers[2] = { m_currentGrid.data(), m_nextGrid.data() };
+
+    // Each worker owns a fixed band of rows for the whole run; the barrier
+    // keeps a generation from reading rows that are still being written
+    m_threadPool->run([&](unsigned worker) {
+        size_t rowBegin = m_height * worker / workers;
+        size_t rowEnd = m_height * (worker + 1) / workers;
+        for (int g = 0; g < generations; ++g) {
+            evolveRuleRegion(m_rule, buffers[g % 2], buffers[(g + 1) % 2], m_width, m_height,
+                             0, m_width, rowBegin, rowEnd);
+            barrier.wait();
+        }
+    });
+
+    if (generations % 2 != 0)
+        m_currentGrid.swap(m_nextGrid);
+    markHostModified();
+    m_generation += generations;
+}
+
+void GameOfLife::evolveSparse(int generations) {
+    syncHostGrid();
+    const size_t tilesX = (m_width + sparseTileSize - 1) / sparseTileSize;
+    const size_t tilesY = (m_height + sparseTileSize - 1) / sparseTileSize;
+    const size_t tileCount = tilesX * tilesY;
+
+    // Without a valid history every tile counts as changed, which also makes
+    // m_nextGrid a full copy of the previous generation after one step
+    if (!m_sparseValid || m_tileChanged.size() != tileCount) {
+        m_tileChanged.assign(tileCount, 1);
+        m_sparseValid = true;
+    }
+    m_sparseStats = SparseStats();
+    m_sparseStats.tileCount = tileCount;
+
+    // Tiles within the rule's range of a changed tile; one for range-1 rules
+    const size_t reach = (static_cast<size_t>(m_rule.range) + sparseTileSize - 1) / sparseTileSize;
+
+    std::vector<unsigned char> active(tileCount);
+    for (int g = 0; g < generations; ++g) {
+        // A tile can only change if it or one of its toroidal neighbours
+        // changed last generation. Skipped tiles already hold the right
+        // state in m_nextGrid, which is two generations old but unchanged.
+        std::fill(active.begin(), active.end(), 0);
+        for (size_t ty = 0; ty < tilesY; ++ty) {
+            for (size_t tx = 0; tx < tilesX; ++tx) {
+                if (!m_tileChanged[ty * tilesX + tx])
+                    continue;
+                for (size_t dy = 0; dy <= 2 * reach; ++dy) {
+                    for (size_t dx = 0; dx <= 2 * reach; ++dx) {
+                        size_t nx = (tx + dx + tilesX - reach % tilesX) % tilesX;
+                        size_t ny = (ty + dy + tilesY - reach % tilesY) % tilesY;
+                        active[ny * tilesX + nx] = 1;
+                    }
+                }
+            }
+        }
+
+        size_t activeTiles = 0;
+        for (size_t ty = 0; ty < tilesY; ++ty) {
+            for (size_t tx = 0; tx < tilesX; ++tx) {
+                size_t tile = ty * tilesX + tx;
+                if (!active[tile]) {
+                    m_tileChanged[tile] = 0;
+                    continue;
+                }
+                ++activeTiles;
+                size_t x0 = tx * sparseTileSize;
+                size_t y0 = ty * sparseTileSize;
+                m_tileChanged[tile] = evolveRuleRegion(m_rule, m_currentGrid.data(), m_nextGrid.data(),
+                                                       m_width, m_height,
+                                                       x0, std::min(x0 + sparseTileSize, m_width),
+                                                       y0, std::min(y0 + sparseTileSize, m_height));
+            }
+        }
+        m_currentGrid.swap(m_nextGrid);
+
+        m_sparseStats.lastActiveTiles = activeTiles;
+        m_sparseStats.totalActiveTiles += activeTiles;
+        ++m_sparseStats.generations;
+    }
+    m_deviceStale = true;
+    m_hashValid = false;
+    m_hashLifeValid = false;
+    m_generation += generations;
+}
+
+const GameOfLife::SparseStats& GameOfLife::getSparseStats() const {
+    return m_sparseStats;
+}
+
+void GameOfLife::evolveHashLife(uint64_t generations, size_t maxNodes) {
+    if (generations == 0)
+        return;
+    // HashLife needs two states, range 1 and an empty world that stays empty
+    if (!m_rule.isLifeLike() || (m_rule.birth & 1u)) {
+        for (uint64_t g = 0; g < generations; ++g)
+            evolveScalar();
+        return;
+    }
+    if (!m_hashLife || !m_hashLife->hasRule(m_rule.birth, m_rule.survival)) {
+        m_hashLife.reset(new HashLife(maxNodes, m_rule.birth, m_rule.survival));
+        m_hashLifeValid = false;
+    }
+    m_hashLife->setMaxNodes(maxNodes);
+    // The grid is only loaded again if something else changed it
+    if (!m_hashLifeValid) {
+        syncHostGrid();
+        m_hashLife->load(m_currentGrid, m_width, m_height);
+    }
+    m_hashLife->advance(generations);
+    m_hashLife->store(m_currentGrid);
+    markHostModified();
+    m_hashLifeValid = true;
+    m_generation += generations;
+}
+
+bool GameOfLife::evolveMultiDevice(int generations, const std::string& devices, unsigned subDevices) {
+    std::string config = devices + "/" + std::to_string(subDevices) + "/" + ruleToString(m_rule);
+    if (!m_multiDevice || config != m_multiDeviceConfig) {
+        m_multiDevice.reset(new MultiDeviceLife(m_width, m_height, m_rule));
+        m_multiDeviceConfig = config;
+        if (!m_multiDevice->initialize(devices, subDevices)) {
+            m_multiDevice.reset();
+            return false;
+        }
+    }
+    if (generations <= 0)
+        return true;
+
+    syncHostGrid();
+    if (!m_multiDevice->upload(m_currentGrid) || !m_multiDevice->evolve(generations)
+        || !m_multiDevice->download(m_currentGrid))
+        return false;
+    markHostModified();
+    m_generation += generations;
+    return true;
+}
+
+std::vector<std::string> GameOfLife::getMultiDeviceStrips() const {
+    if (!m_multiDevice)
+        return std::vector<std::string>();
+    return m_multiDevice->describeStrips();
+}
+
+void GameOfLife::markHostModified() {
+    m_deviceStale = true;
+    m_sparseValid = false;
+    m_hashValid = false;
+    m_hashLifeValid = false;
 }
 
 void GameOfLife::print() const {
+    syncHostGrid();
     for (size_t y = 0; y < m_height; ++y) {
         for (size_t x = 0; x < m_width; ++x) {
-            std::cout << (m_currentGrid[cellIndex(x, y)] ? "*" : ".");
+            int state = m_currentGrid[cellIndex(x, y)];
+            std::cout << (state == 0 ? "." : state == 1 ? "*" : "+");
         }
         std::cout << "\n";
     }
     std::cout << "\n";
 }
 
-void GameOfLife::randomize(double aliveProbability) {
-    for (size_t y = 0; y < m_height; ++y) {
-        for (size_t x = 0; x < m_width; ++x) {
-            double r = static_cast<double>(rand()) / RAND_MAX;
-            m_currentGrid[cellIndex(x, y)] = (r < aliveProbability) ? 1 : 0;
-        }
+void GameOfLife::randomize(double aliveProbability, uint64_t seed) {
+    m_hostStale = false;
+    if (m_mappedWorld || m_bitGrid || m_simdGrid) {
+        // Every cell is overwritten, so no other copy needs unpacking
+        m_mappedWorld.reset();
+        m_bitGrid.reset();
+        m_simdGrid.reset();
+        m_currentGrid.resize(m_width * m_height);
+        m_nextGrid.resize(m_width * m_height, 0);
+    }
+    if (!m_threadPool)
+        m_threadPool.reset(new ThreadPool());
+
+    // Each worker fills a contiguous range of cells; the result does not
+    // depend on how the ranges are split
+    const uint64_t threshold = aliveThreshold(aliveProbability);
+    const size_t cells = m_width * m_height;
+    const unsigned workers = m_threadPool->size();
+    m_threadPool->run([&](unsigned worker) {
+        size_t begin = cells * worker / workers;
+        size_t end = cells * (worker + 1) / workers;
+        fillRandomCells(m_currentGrid.data() + begin, begin, end - begin, seed, 0, threshold);
+    });
+    markHostModified();
+}
+
+bool GameOfLife::randomizeOpenCL(double aliveProbability, uint64_t seed) {
+    if (!initializeOpenCL() || !createGridBuffers())
+        return false;
+
+    const bool packed = deviceStorage() == CellStorage::BitPacked;
+    cl_int err = CL_SUCCESS;
+    cl_kernel kernel = clCreateKernel(program, packed ? "randomWords" : "randomCells", &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create random fill kernel." << std::endl;
+        return false;
+    }
+
+    cl_ulong key = seed;
+    cl_ulong threshold = aliveThreshold(aliveProbability);
+    size_t globalWorkSize[2] = { 0, 1 };
+    if (packed) {
+        cl_int width = static_cast<cl_int>(m_width);
+        cl_int height = static_cast<cl_int>(m_height);
+        err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &gridBuffers[currentBufferIndex]);
+        err |= clSetKernelArg(kernel, 1, sizeof(cl_int), &width);
+        err |= clSetKernelArg(kernel, 2, sizeof(cl_int), &height);
+        err |= clSetKernelArg(kernel, 3, sizeof(cl_ulong), &key);
+        err |= clSetKernelArg(kernel, 4, sizeof(cl_ulong), &threshold);
+        globalWorkSize[0] = (m_width + 63) / 64;
+        globalWorkSize[1] = m_height;
+    } else {
+        cl_ulong cells = static_cast<cl_ulong>(m_width) * m_height;
+        err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &gridBuffers[currentBufferIndex]);
+        err |= clSetKernelArg(kernel, 1, sizeof(cl_ulong), &cells);
+        err |= clSetKernelArg(kernel, 2, sizeof(cl_ulong), &key);
+        err |= clSetKernelArg(kernel, 3, sizeof(cl_ulong), &threshold);
+        globalWorkSize[0] = (cells + 3) / 4;
+    }
+    if (err == CL_SUCCESS)
+        err = clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalWorkSize, nullptr, 0, nullptr, nullptr);
+    clReleaseKernel(kernel);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to execute random fill kernel." << std::endl;
+        return false;
+    }
+
+    // The host grid only needs its size for the eventual readback
+    if (m_mappedWorld || m_bitGrid || m_simdGrid) {
+        m_mappedWorld.reset();
+        m_bitGrid.reset();
+        m_simdGrid.reset();
+        m_currentGrid.resize(m_width * m_height);
+        m_nextGrid.resize(m_width * m_height, 0);
     }
+    markHostModified();
+    m_deviceStale = false;
+    m_hostStale = true;
+    return true;
 }
 
 void GameOfLife::setCellState(size_t x, size_t y, int state) {
-    if (x < m_width && y < m_height)
-        m_currentGrid[cellIndex(x, y)] = state;
+    if (x < m_width && y < m_height) {
+        syncHostGrid();
+        size_t index = cellIndex(x, y);
+        bool trackHash = m_hashValid;
+        m_gridHash += cellHash(index, state) - cellHash(index, m_currentGrid[index]);
+        m_currentGrid[index] = state;
+        markHostModified();
+        m_hashValid = trackHash;
+    }
+}
+
+void GameOfLife::stampPattern(const Pattern& pattern, long long x, long long y) {
+    const long long width = static_cast<long long>(m_width);
+    const long long height = static_cast<long long>(m_height);
+    const long long columnBegin = std::max(0LL, -x);
+    const long long columnEnd = std::min(static_cast<long long>(pattern.getWidth()), width - x);
+    if (columnBegin >= columnEnd)
+        return;
+
+    const long long rowBegin = std::max(0LL, -y);
+    const long long rowEnd = std::min(static_cast<long long>(pattern.getHeight()), height - y);
+    if (m_bitGrid) {
+        // A resident bit grid takes the pattern rows a word at a time
+        for (long long py = rowBegin; py < rowEnd; ++py)
+            m_bitGrid->setRowBits(static_cast<size_t>(y + py), static_cast<size_t>(x + columnBegin),
+                                  pattern.row(static_cast<size_t>(py)), static_cast<size_t>(columnBegin),
+                                  static_cast<size_t>(columnEnd - columnBegin));
+        markHostModified();
+        return;
+    }
+
+    syncHostGrid();
+    for (long long py = rowBegin; py < rowEnd; ++py) {
+        // Whole words of dead cells are skipped; each run of live bits is one fill
+        const uint64_t* words = pattern.row(static_cast<size_t>(py));
+        int* row = m_currentGrid.data() + (y + py) * width;
+        for (long long w = columnBegin / 64; w * 64 < columnEnd; ++w) {
+            uint64_t word = words[w];
+            if (w * 64 < columnBegin)
+                word &= ~uint64_t(0) << (columnBegin - w * 64);
+            if (columnEnd - w * 64 < 64)
+                word &= (uint64_t(1) << (columnEnd - w * 64)) - 1;
+            while (word != 0) {
+                int start = __builtin_ctzll(word);
+                uint64_t rest = ~(word >> start);
+                int length = rest == 0 ? 64 - start : __builtin_ctzll(rest);
+                std::fill_n(row + x + w * 64 + start, length, 1);
+                word = start + length == 64 ? 0 : word & (~uint64_t(0) << (start + length));
+            }
+        }
+    }
+    markHostModified();
 }
 
 int GameOfLife::getCellState(size_t x, size_t y) const {
-    if (x < m_width && y < m_height)
+    if (x < m_width && y < m_height) {
+        syncHostGrid();
         return m_currentGrid[cellIndex(x, y)];
+    }
     return 0;
 }
 
@@ -154,24 +1165,18 @@ int GameOfLife::getCellState1D(size_t idx) const {
     return getCellState(x, y);
 }
 
-void GameOfLife::saveToFile(const std::string &filename) {
-    std::ofstream ofs(filename.c_str());
-    if (!ofs) {
-        throw std::runtime_error("Could not open file for writing: " + filename);
-    }
-    
-    ofs << m_width << " " << m_height << "\n";
-    
-    for (size_t y = 0; y < m_height; ++y) {
-        for (size_t x = 0; x < m_width; ++x) {
-            ofs << m_currentGrid[y * m_width + x];
-            if (x < m_width - 1)
-                ofs << " ";
-        }
-        ofs << "\n";
-    }
-    
-    ofs.close();
+void GameOfLife::saveToFile(const std::string &filename, WorldFileFormat format) {
+    syncHostGrid();
+    saveWorldFile(filename, m_currentGrid, m_width, m_height, format, m_generation, m_rule.states,
+                  ruleToString(m_rule));
+}
+
+void GameOfLife::saveCheckpoint(const std::string &filename) {
+    if (m_rule.states > 2)
+        throw std::invalid_argument("Bit-packed checkpoints hold two states; save worlds with " +
+                                    std::to_string(m_rule.states) + " states with saveToFile().");
+    syncHostGrid();
+    saveMappedWorldFile(filename, m_currentGrid, m_width, m_height, m_generation, ruleToString(m_rule));
 }
 
 size_t GameOfLife::getWidth() const {
@@ -183,46 +1188,56 @@ size_t GameOfLife::getHeight() const {
 }
 
 const std::vector<int>& GameOfLife::getCurrentGrid() const {
+    syncHostGrid();
     return m_currentGrid;
 }
 
+uint64_t GameOfLife::getGridHash() const {
+    if (!m_hashValid) {
+        syncHostGrid();
+        m_gridHash = gridHash(m_currentGrid);
+        m_hashValid = true;
+    }
+    return m_gridHash;
+}
+
+uint64_t GameOfLife::getGeneration() const {
+    return m_generation;
+}
+
+void GameOfLife::setGeneration(uint64_t generation) {
+    m_generation = generation;
+}
+
 bool GameOfLife::initializeOpenCL() {
     if (openclInitialized) return true;
     
     cl_int err = CL_SUCCESS;
+    auto initStart = std::chrono::steady_clock::now();
     
-    // Get platform
-    cl_uint numPlatforms = 0;
-    err = clGetPlatformIDs(0, nullptr, &numPlatforms);
-    if (err != CL_SUCCESS || numPlatforms == 0) {
-        std::cerr << "Failed to find any OpenCL platforms." << std::endl;
+    std::vector<OpenCLDeviceInfo> devices = listOpenCLDevices();
+    if (devices.empty()) {
+        std::cerr << "No OpenCL devices found." << std::endl;
         return false;
     }
 
-    std::vector<cl_platform_id> platforms(numPlatforms);
-    err = clGetPlatformIDs(numPlatforms, platforms.data(), nullptr);
-    cl_platform_id platform = platforms[0];
+    // An explicit selection wins over the environment
+    std::string selector = m_deviceSelector;
+    if (selector.empty()) {
+        const char* envSelector = std::getenv("GOL_OPENCL_DEVICE");
+        if (envSelector)
+            selector = envSelector;
+    }
+    if (selector == "auto")
+        selector = calibrateOpenCLDevice(devices);
 
-    // Get device
-    cl_uint numDevices = 0;
-    err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 0, nullptr, &numDevices);
-    std::vector<cl_device_id> devices;
-    
-    if (numDevices == 0) {
-        // Try CPU if no GPU is available
-        err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_CPU, 0, nullptr, &numDevices);
-        if (numDevices == 0) {
-            std::cerr << "No OpenCL devices found." << std::endl;
-            return false;
-        }
-        devices.resize(numDevices);
-        err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_CPU, numDevices, devices.data(), nullptr);
-    } else {
-        devices.resize(numDevices);
-        err = clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, numDevices, devices.data(), nullptr);
+    size_t deviceIndex = 0;
+    if (!findOpenCLDevice(devices, selector, deviceIndex)) {
+        std::cerr << "No OpenCL device matches '" << selector << "'." << std::endl;
+        return false;
     }
-    
-    device = devices[0];
+    device = devices[deviceIndex].id;
+    m_startup.deviceName = devices[deviceIndex].name;
 
     // Create context
     context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &err);
@@ -231,152 +1246,850 @@ bool GameOfLife::initializeOpenCL() {
         return false;
     }
 
+    if (!createQueues()) {
+        cleanupOpenCL();
+        return false;
+    }
+
+    // Create program
+    // The rule is compiled in, so each rule gets its own program
+    std::string kernelSource = std::string(ruleKernelMacros()) + golKernelSource;
+    std::string buildOptions = "-DTILED_ROWS_PER_ITEM=" + std::to_string(tiledRowsPerItem)
+                             + " -DCELL_T=" + (deviceStorage() == CellStorage::UChar ? "uchar" : "int")
+                             + " " + ruleBuildOptions(m_rule);
+    ProgramCacheKey cacheKey = makeProgramCacheKey(device, kernelSource, buildOptions);
+    auto buildStart = std::chrono::steady_clock::now();
+
+    // Try a cached binary first; any mismatch falls through to a source build
+    std::vector<unsigned char> binary;
+    m_startup.programFromCache = false;
+    if (loadProgramBinary(cacheKey, binary)) {
+        const unsigned char* binaryData = binary.data();
+        size_t binarySize = binary.size();
+        cl_int binaryStatus = CL_SUCCESS;
+        program = clCreateProgramWithBinary(context, 1, &device, &binarySize, &binaryData, &binaryStatus, &err);
+        if (err == CL_SUCCESS && binaryStatus == CL_SUCCESS
+            && clBuildProgram(program, 1, &device, buildOptions.c_str(), nullptr, nullptr) == CL_SUCCESS) {
+            m_startup.programFromCache = true;
+        } else {
+            if (program) clReleaseProgram(program);
+            program = nullptr;
+        }
+    }
+
+    if (!program) {
+        const char* source = kernelSource.c_str();
+        size_t sourceSize = kernelSource.size();
+        program = clCreateProgramWithSource(context, 1, &source, &sourceSize, &err);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to create program." << std::endl;
+            program = nullptr;
+            cleanupOpenCL();
+            return false;
+        }
+
+        // Build program
+        err = clBuildProgram(program, 1, &device, buildOptions.c_str(), nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            size_t logSize;
+            clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
+            std::string buildLog(logSize, ' ');
+            clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, logSize, &buildLog[0], nullptr);
+            std::cerr << "Build error:\n" << buildLog << std::endl;
+            cleanupOpenCL();
+            return false;
+        }
+        storeProgramBinary(cacheKey, program);
+    }
+    if (m_profiling)
+        m_buildSamples.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - buildStart).count());
+
+    if (!createKernels()) {
+        cleanupOpenCL();
+        return false;
+    }
+
+    openclInitialized = true;
+    m_startup.initMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - initStart).count();
+    ++m_startup.initializations;
+    return true;
+}
+
+bool GameOfLife::createQueues() {
+    cl_int err = CL_SUCCESS;
+    cl_command_queue_properties properties = m_profiling ? CL_QUEUE_PROFILING_ENABLE : 0;
+
     // Create command queue - use OpenCL 1.2 version
     // Replace clCreateCommandQueueWithProperties with clCreateCommandQueue
-    queue = clCreateCommandQueue(context, device, 0, &err);
+    queue = clCreateCommandQueue(context, device, properties, &err);
     if (err != CL_SUCCESS) {
         std::cerr << "Failed to create command queue." << std::endl;
-        cleanupOpenCL();
+        queue = nullptr;
         return false;
     }
 
-    // Create program
-    const char* source = golKernelSource;
-    size_t sourceSize = std::strlen(source);
-    program = clCreateProgramWithSource(context, 1, &source, &sourceSize, &err);
+    // Separate queue for snapshot readbacks so they overlap with kernels
+    transferQueue = clCreateCommandQueue(context, device, properties, &err);
     if (err != CL_SUCCESS) {
-        std::cerr << "Failed to create program." << std::endl;
-        cleanupOpenCL();
+        std::cerr << "Failed to create transfer queue." << std::endl;
+        transferQueue = nullptr;
         return false;
     }
+    return true;
+}
 
-    // Build program
-    err = clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr);
-    if (err != CL_SUCCESS) {
-        size_t logSize;
-        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
-        std::string buildLog(logSize, ' ');
-        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, logSize, &buildLog[0], nullptr);
-        std::cerr << "Build error:\n" << buildLog << std::endl;
-        cleanupOpenCL();
+bool GameOfLife::createKernels() {
+    cl_int err = CL_SUCCESS;
+    for (int i = 0; i < 2; ++i) {
+        if (kernels[i]) clReleaseKernel(kernels[i]);
+        kernels[i] = nullptr;
+    }
+
+    // Create one kernel per ping-pong direction so buffer arguments are set once
+    const char* kernelName = "evolveToroidal";
+    if (deviceStorage() == CellStorage::BitPacked)
+        kernelName = "evolveBitPacked";
+    else if (m_rule.isLargerThanLife())
+        kernelName = "evolveLargerThanLife";
+    else if (m_kernelVariant == KernelVariant::Tiled)
+        kernelName = "evolveToroidalTiled";
+    else if (m_kernelVariant == KernelVariant::TemporalBlocked)
+        kernelName = "evolveToroidalBlocked";
+    cl_int width = static_cast<cl_int>(m_width);
+    cl_int height = static_cast<cl_int>(m_height);
+    for (int i = 0; i < 2; ++i) {
+        kernels[i] = clCreateKernel(program, kernelName, &err);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to create kernel." << std::endl;
+            kernels[i] = nullptr;
+            return false;
+        }
+
+        err = clSetKernelArg(kernels[i], 2, sizeof(cl_int), &width);
+        err |= clSetKernelArg(kernels[i], 3, sizeof(cl_int), &height);
+        if (gridBuffers[0] && gridBuffers[1]) {
+            err |= clSetKernelArg(kernels[i], 0, sizeof(cl_mem), &gridBuffers[i]);
+            err |= clSetKernelArg(kernels[i], 1, sizeof(cl_mem), &gridBuffers[1 - i]);
+        }
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to set kernel arguments." << std::endl;
+            return false;
+        }
+    }
+
+    localWorkSize[0] = localWorkSize[1] = 0;
+    if (deviceVariant() == KernelVariant::Naive)
+        return true;
+
+    size_t maxGroup = 1;
+    cl_ulong localMemSize = 0;
+    clGetKernelWorkGroupInfo(kernels[0], device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &maxGroup, nullptr);
+    clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &localMemSize, nullptr);
+
+    size_t groupSize = 1;
+    while (groupSize * 2 <= maxGroup && groupSize * 2 <= 256)
+        groupSize *= 2;
+
+    if (m_kernelVariant == KernelVariant::TemporalBlocked) {
+        // Square-ish tile; both local regions carry a halo of the full block depth
+        size_t groupW = 1;
+        while (groupW * groupW < groupSize)
+            groupW *= 2;
+        size_t groupH = groupSize / groupW;
+        size_t halo = 2 * static_cast<size_t>(m_blockDepth);
+        size_t regionBytes = 0;
+        while (true) {
+            regionBytes = sizeof(cl_int) * (groupW + halo) * (groupH + halo);
+            if (2 * regionBytes <= localMemSize || (groupW == 1 && groupH == 1))
+                break;
+            if (groupW >= groupH)
+                groupW /= 2;
+            else
+                groupH /= 2;
+        }
+        if (2 * regionBytes > localMemSize) {
+            std::cerr << "Temporal block depth " << m_blockDepth << " does not fit in device local memory." << std::endl;
+            return false;
+        }
+        localWorkSize[0] = groupW;
+        localWorkSize[1] = groupH;
+
+        cl_int depth = m_blockDepth;
+        for (int i = 0; i < 2; ++i) {
+            err = clSetKernelArg(kernels[i], 4, sizeof(cl_int), &depth);
+            err |= clSetKernelArg(kernels[i], 5, regionBytes, nullptr);
+            err |= clSetKernelArg(kernels[i], 6, regionBytes, nullptr);
+            if (err != CL_SUCCESS) {
+                std::cerr << "Failed to set local memory arguments." << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Largest power-of-two work-group the kernel and device allow, as wide as
+    // a 32-cell row, shrunk in height until the tile fits in local memory
+    size_t groupW = (groupSize < 32) ? groupSize : 32;
+    size_t groupH = groupSize / groupW;
+    size_t tileBytes = 0;
+    while (true) {
+        tileBytes = sizeof(cl_int) * (groupW + 2) * (groupH * tiledRowsPerItem + 2);
+        if (tileBytes <= localMemSize || groupH == 1)
+            break;
+        groupH /= 2;
+    }
+    if (tileBytes > localMemSize) {
+        std::cerr << "Tiled kernel does not fit in device local memory." << std::endl;
         return false;
     }
+    localWorkSize[0] = groupW;
+    localWorkSize[1] = groupH;
+
+    for (int i = 0; i < 2; ++i) {
+        err = clSetKernelArg(kernels[i], 4, tileBytes, nullptr);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to set local memory argument." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
-    // Create kernel
-    kernel = clCreateKernel(program, "evolveToroidal", &err);
+bool GameOfLife::createHashKernel() {
+    cl_int err = CL_SUCCESS;
+    bool packed = deviceStorage() == CellStorage::BitPacked;
+    hashKernel = clCreateKernel(program, packed ? "hashWords" : "hashCells", &err);
     if (err != CL_SUCCESS) {
-        std::cerr << "Failed to create kernel." << std::endl;
-        cleanupOpenCL();
+        std::cerr << "Failed to create hash kernel." << std::endl;
+        hashKernel = nullptr;
         return false;
     }
 
-    // Set fixed kernel arguments
-    err = clSetKernelArg(kernel, 2, sizeof(int), &m_width);
-    err |= clSetKernelArg(kernel, 3, sizeof(int), &m_height);
+    // Power-of-two work-groups for the tree reduction, and a few groups per
+    // compute unit; each work-item sums a strided share of the grid
+    size_t maxGroup = 1;
+    cl_uint computeUnits = 1;
+    clGetKernelWorkGroupInfo(hashKernel, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &maxGroup, nullptr);
+    clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &computeUnits, nullptr);
+    hashGroupSize = 1;
+    while (hashGroupSize * 2 <= maxGroup && hashGroupSize * 2 <= 256)
+        hashGroupSize *= 2;
+    size_t items = packed ? (m_width + 63) / 64 * m_height : m_width * m_height;
+    hashGroups = std::max<size_t>(1, std::min<size_t>(4 * static_cast<size_t>(computeUnits),
+                                                      (items + hashGroupSize - 1) / hashGroupSize));
+
+    // Two halves of hashBatchGenerations slots each
+    hashBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_ulong) * 2 * hashBatchGenerations * hashGroups,
+                                nullptr, &err);
     if (err != CL_SUCCESS) {
-        std::cerr << "Failed to set kernel arguments." << std::endl;
-        cleanupOpenCL();
+        std::cerr << "Failed to create hash buffer." << std::endl;
+        hashBuffer = nullptr;
         return false;
     }
 
-    openclInitialized = true;
+    size_t localBytes = sizeof(cl_ulong) * hashGroupSize;
+    if (packed) {
+        cl_int width = static_cast<cl_int>(m_width);
+        cl_int height = static_cast<cl_int>(m_height);
+        err = clSetKernelArg(hashKernel, 1, sizeof(cl_int), &width);
+        err |= clSetKernelArg(hashKernel, 2, sizeof(cl_int), &height);
+        err |= clSetKernelArg(hashKernel, 3, sizeof(cl_mem), &hashBuffer);
+        err |= clSetKernelArg(hashKernel, 5, localBytes, nullptr);
+    } else {
+        cl_ulong cells = static_cast<cl_ulong>(m_width) * m_height;
+        err = clSetKernelArg(hashKernel, 1, sizeof(cl_ulong), &cells);
+        err |= clSetKernelArg(hashKernel, 2, sizeof(cl_mem), &hashBuffer);
+        err |= clSetKernelArg(hashKernel, 4, localBytes, nullptr);
+    }
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to set hash kernel arguments." << std::endl;
+        return false;
+    }
     return true;
 }
 
+void GameOfLife::setKernelVariant(KernelVariant variant) {
+    if (variant == m_kernelVariant)
+        return;
+    m_kernelVariant = variant;
+    if (openclInitialized && !createKernels())
+        cleanupOpenCL();
+}
+
+GameOfLife::KernelVariant GameOfLife::getKernelVariant() const {
+    return m_kernelVariant;
+}
+
+void GameOfLife::setTemporalBlockDepth(int depth) {
+    if (depth < 1)
+        depth = 1;
+    if (depth == m_blockDepth)
+        return;
+    m_blockDepth = depth;
+    if (openclInitialized && m_kernelVariant == KernelVariant::TemporalBlocked && !createKernels())
+        cleanupOpenCL();
+}
+
+int GameOfLife::getTemporalBlockDepth() const {
+    return m_blockDepth;
+}
+
+void GameOfLife::setCellStorage(CellStorage storage) {
+    if (storage == m_cellStorage)
+        return;
+    // Buffers and the program depend on the cell type; the old buffers are
+    // read back before they are released
+    if (openclInitialized)
+        cleanupOpenCL();
+    m_cellStorage = storage;
+}
+
+GameOfLife::CellStorage GameOfLife::getCellStorage() const {
+    return m_cellStorage;
+}
+
+GameOfLife::CellStorage GameOfLife::deviceStorage() const {
+    // Dying states need more than a bit, so those rules fall back to bytes
+    if (m_cellStorage == CellStorage::BitPacked && !m_rule.isLifeLike())
+        return CellStorage::UChar;
+    return m_cellStorage;
+}
+
+GameOfLife::KernelVariant GameOfLife::deviceVariant() const {
+    // Bit-packed storage and Larger than Life rules have a single kernel each
+    if (deviceStorage() == CellStorage::BitPacked || m_rule.isLargerThanLife())
+        return KernelVariant::Naive;
+    return m_kernelVariant;
+}
+
+void GameOfLife::setRule(const Rule& rule) {
+    if (rule == m_rule)
+        return;
+    // The program is specialized for the rule; the old buffers are read
+    // back before they are released
+    if (openclInitialized)
+        cleanupOpenCL();
+    m_multiDevice.reset();
+    if (rule.states < m_rule.states) {
+        // States the new rule does not have become dead cells
+        syncHostGrid();
+        for (int& cell : m_currentGrid)
+            if (cell >= rule.states)
+                cell = 0;
+    }
+    m_rule = rule;
+    markHostModified();
+}
+
+const Rule& GameOfLife::getRule() const {
+    return m_rule;
+}
+
+void GameOfLife::setSimdIsa(SimdIsa isa) {
+    m_simdIsa = SimdLife::isSupported(isa) ? isa : SimdLife::bestIsa();
+}
+
+SimdIsa GameOfLife::getSimdIsa() const {
+    return m_simdIsa;
+}
+
+size_t GameOfLife::deviceGridBytes() const {
+    if (deviceStorage() == CellStorage::UChar)
+        return m_width * m_height;
+    if (deviceStorage() == CellStorage::BitPacked)
+        return sizeof(uint64_t) * ((m_width + 63) / 64) * m_height;
+    return sizeof(int) * m_width * m_height;
+}
+
+void GameOfLife::setOpenCLDevice(const std::string& selector) {
+    if (selector == m_deviceSelector)
+        return;
+    m_deviceSelector = selector;
+    m_calibratedDevice.clear();
+    // The next evolveOpenCL() call initializes on the new device
+    if (openclInitialized)
+        cleanupOpenCL();
+}
+
+const std::string& GameOfLife::getOpenCLDevice() const {
+    return m_deviceSelector;
+}
+
+std::string GameOfLife::calibrateOpenCLDevice(const std::vector<OpenCLDeviceInfo>& devices) {
+    if (!m_calibratedDevice.empty())
+        return m_calibratedDevice;
+
+    // Times a few naive generations of an empty world of the current size,
+    // capped so calibration stays short on huge worlds
+    const size_t maxSide = 2048;
+    const int calibrationGenerations = 8;
+    size_t width = std::min(m_width, maxSide);
+    size_t height = std::min(m_height, maxSide);
+    double bestTime = 0.0;
+    std::string best;
+    for (const OpenCLDeviceInfo& info : devices) {
+        GameOfLife probe(width, height);
+        probe.setOpenCLDevice(std::to_string(info.index));
+        if (!probe.evolveOpenCL(1))
+            continue;
+        auto start = std::chrono::steady_clock::now();
+        if (!probe.evolveOpenCL(calibrationGenerations))
+            continue;
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (best.empty() || elapsed < bestTime) {
+            bestTime = elapsed;
+            best = std::to_string(info.index);
+        }
+    }
+    m_calibratedDevice = best;
+    return best;
+}
+
+void GameOfLife::setOpenCLProfiling(bool enabled) {
+    if (enabled == m_profiling)
+        return;
+    m_profiling = enabled;
+    if (!openclInitialized)
+        return;
+
+    // Queue properties are fixed at creation; buffers and kernels belong to
+    // the context and survive the new queues
+    syncHostGrid();
+    clFinish(transferQueue);
+    clFinish(queue);
+    clReleaseCommandQueue(transferQueue);
+    clReleaseCommandQueue(queue);
+    transferQueue = nullptr;
+    queue = nullptr;
+    if (!createQueues())
+        cleanupOpenCL();
+}
+
+bool GameOfLife::getOpenCLProfiling() const {
+    return m_profiling;
+}
+
+const GameOfLife::OpenCLStartup& GameOfLife::getOpenCLStartup() const {
+    return m_startup;
+}
+
+GameOfLife::OpenCLProfile GameOfLife::getOpenCLProfile() const {
+    OpenCLProfile profile;
+    profile.build = summarizeSamples(m_buildSamples);
+    profile.upload = summarizeSamples(m_uploadSamples);
+    profile.kernel = summarizeSamples(m_kernelSamples);
+    profile.readback = summarizeSamples(m_readbackSamples);
+    return profile;
+}
+
+void GameOfLife::resetOpenCLProfile() {
+    m_buildSamples.clear();
+    m_uploadSamples.clear();
+    m_kernelSamples.clear();
+    m_readbackSamples.clear();
+}
+
 void GameOfLife::cleanupOpenCL() {
-    if (currentBuffer) clReleaseMemObject(currentBuffer);
-    if (nextBuffer) clReleaseMemObject(nextBuffer);
-    if (kernel) clReleaseKernel(kernel);
+    // Keep the latest generation if it only exists on the device. A mapped
+    // world or resident bit grid does not depend on the context and stays
+    // as it is
+    if (m_hostStale)
+        syncHostGrid();
+
+    for (int i = 0; i < 2; ++i) {
+        if (gridBuffers[i]) clReleaseMemObject(gridBuffers[i]);
+        if (kernels[i]) clReleaseKernel(kernels[i]);
+        gridBuffers[i] = nullptr;
+        kernels[i] = nullptr;
+    }
+    if (hashBuffer) clReleaseMemObject(hashBuffer);
+    if (hashKernel) clReleaseKernel(hashKernel);
+    hashBuffer = nullptr;
+    hashKernel = nullptr;
     if (program) clReleaseProgram(program);
+    if (transferQueue) clReleaseCommandQueue(transferQueue);
     if (queue) clReleaseCommandQueue(queue);
     if (context) clReleaseContext(context);
     
-    currentBuffer = nullptr;
-    nextBuffer = nullptr;
-    kernel = nullptr;
     program = nullptr;
+    transferQueue = nullptr;
     queue = nullptr;
     context = nullptr;
     device = nullptr;
+    currentBufferIndex = 0;
     openclInitialized = false;
+    m_hostStale = false;
+    m_deviceStale = true;
 }
 
-bool GameOfLife::evolveOpenCL(int generations) {
-    if (!initializeOpenCL()) {
-        return false;
+bool GameOfLife::createGridBuffers() {
+    cl_int err = CL_SUCCESS;
+    size_t gridBytes = deviceGridBytes();
+
+    // Buffers live as long as the context; the world size never changes
+    if (!gridBuffers[0] || !gridBuffers[1]) {
+        for (int i = 0; i < 2; ++i) {
+            gridBuffers[i] = clCreateBuffer(context, CL_MEM_READ_WRITE, gridBytes, nullptr, &err);
+            if (err != CL_SUCCESS) {
+                std::cerr << "Failed to create grid buffer." << std::endl;
+                gridBuffers[i] = nullptr;
+                return false;
+            }
+        }
+        for (int i = 0; i < 2; ++i) {
+            err = clSetKernelArg(kernels[i], 0, sizeof(cl_mem), &gridBuffers[i]);
+            err |= clSetKernelArg(kernels[i], 1, sizeof(cl_mem), &gridBuffers[1 - i]);
+            if (err != CL_SUCCESS) {
+                std::cerr << "Failed to set kernel buffer arguments." << std::endl;
+                return false;
+            }
+        }
+        currentBufferIndex = 0;
+        m_deviceStale = true;
     }
-    
+    return true;
+}
+
+bool GameOfLife::syncDeviceGrid() {
+    if (!createGridBuffers())
+        return false;
+
     cl_int err = CL_SUCCESS;
-    size_t gridSize = m_width * m_height;
-    
-    currentBuffer = clCreateBuffer(
-        context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
-        sizeof(int) * gridSize, m_currentGrid.data(), &err
-    );
+    size_t gridBytes = deviceGridBytes();
+    if (m_deviceStale) {
+        syncHostGrid();
+        const void* hostCells = m_currentGrid.data();
+        if (deviceStorage() != CellStorage::Int) {
+            packDeviceCells(deviceStorage(), m_currentGrid, m_width, m_height, m_deviceStaging);
+            hostCells = m_deviceStaging.data();
+        }
+        cl_event uploadDone = nullptr;
+        err = clEnqueueWriteBuffer(queue, gridBuffers[currentBufferIndex], CL_TRUE, 0, gridBytes,
+                                   hostCells, 0, nullptr, m_profiling ? &uploadDone : nullptr);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to upload grid." << std::endl;
+            return false;
+        }
+        if (uploadDone) {
+            recordEventTime(uploadDone, m_uploadSamples);
+            clReleaseEvent(uploadDone);
+        }
+        m_deviceStale = false;
+    }
+    return true;
+}
+
+void GameOfLife::syncHostGrid() const {
+    if (m_bitGrid) {
+        m_bitGrid->unpack(m_currentGrid);
+        m_nextGrid.resize(m_width * m_height, 0);
+        m_bitGrid.reset();
+        return;
+    }
+    if (m_simdGrid) {
+        m_simdGrid->unpack(m_currentGrid);
+        m_nextGrid.resize(m_width * m_height, 0);
+        m_simdGrid.reset();
+        return;
+    }
+    if (m_mappedWorld) {
+        unpackMappedWorld(*m_mappedWorld, m_mappedHeader, m_currentGrid);
+        m_nextGrid.resize(m_width * m_height, 0);
+        m_mappedWorld.reset();
+        return;
+    }
+    if (!m_hostStale)
+        return;
+
+    void* hostCells = m_currentGrid.data();
+    if (deviceStorage() != CellStorage::Int) {
+        m_deviceStaging.resize(deviceGridBytes());
+        hostCells = m_deviceStaging.data();
+    }
+    cl_event readDone = nullptr;
+    cl_int err = clEnqueueReadBuffer(queue, gridBuffers[currentBufferIndex], CL_TRUE, 0, deviceGridBytes(),
+                                     hostCells, 0, nullptr, m_profiling ? &readDone : nullptr);
     if (err != CL_SUCCESS) {
-        std::cerr << "Failed to create current buffer." << std::endl;
-        cleanupOpenCL();
-        return false;
+        std::cerr << "Failed to read back results." << std::endl;
+        return;
     }
-    
-    nextBuffer = clCreateBuffer(
-        context, CL_MEM_READ_WRITE, sizeof(int) * gridSize, nullptr, &err
-    );
+    if (deviceStorage() != CellStorage::Int)
+        unpackDeviceCells(deviceStorage(), m_deviceStaging, m_width, m_height, m_currentGrid.data());
+    if (readDone) {
+        recordEventTime(readDone, m_readbackSamples);
+        clReleaseEvent(readDone);
+    }
+    m_hostStale = false;
+}
+
+// Host-side destination of one non-blocking snapshot readback. Compact
+// device layouts are read into raw and unpacked on delivery.
+struct SnapshotSlot {
+    std::vector<int> grid;
+    std::vector<unsigned char> raw;
+    GameOfLife::CellStorage storage = GameOfLife::CellStorage::Int;
+    size_t width = 0;
+    size_t height = 0;
+    cl_event readDone = nullptr;
+    int generation = 0;
+};
+
+// profileSamples receives the readback time when profiling is enabled
+static bool deliverSnapshot(SnapshotSlot& slot, const GameOfLife::SnapshotCallback& onSnapshot,
+                            std::vector<double>* profileSamples) {
+    if (!slot.readDone)
+        return true;
+    cl_int err = clWaitForEvents(1, &slot.readDone);
+    if (err == CL_SUCCESS && profileSamples)
+        recordEventTime(slot.readDone, *profileSamples);
+    clReleaseEvent(slot.readDone);
+    slot.readDone = nullptr;
     if (err != CL_SUCCESS) {
-        std::cerr << "Failed to create next buffer." << std::endl;
-        if (currentBuffer) clReleaseMemObject(currentBuffer);
-        cleanupOpenCL();
+        std::cerr << "Failed to read back snapshot." << std::endl;
         return false;
     }
-    
-    size_t globalWorkSize[2] = { m_width, m_height };
-    
-    err = clSetKernelArg(kernel, 2, sizeof(int), &m_width);
-    err |= clSetKernelArg(kernel, 3, sizeof(int), &m_height);
+    if (slot.storage != GameOfLife::CellStorage::Int)
+        unpackDeviceCells(slot.storage, slot.raw, slot.width, slot.height, slot.grid.data());
+    if (onSnapshot)
+        onSnapshot(slot.generation, slot.grid);
+    return true;
+}
+
+// Grid hashes of up to hashBatchGenerations generations, held in one half
+// of hashBuffer: the generation of each slot and the work-group partial
+// sums read back for it
+struct HashBatch {
+    std::vector<int> generations;
+    std::vector<cl_ulong> partials;
+    cl_event readDone = nullptr;
+};
+
+// Reports the batch's hashes in order; lastHash receives the hash of the
+// batch's final generation
+static bool deliverHashBatch(HashBatch& batch, size_t groups, const GameOfLife::HashCallback& onHash,
+                             bool& stop, int& lastGeneration, uint64_t& lastHash) {
+    if (!batch.readDone)
+        return true;
+    cl_int err = clWaitForEvents(1, &batch.readDone);
+    clReleaseEvent(batch.readDone);
+    batch.readDone = nullptr;
     if (err != CL_SUCCESS) {
-        std::cerr << "Failed to set kernel arguments." << std::endl;
-        cleanupOpenCL();
+        std::cerr << "Failed to read back grid hashes." << std::endl;
+        batch.generations.clear();
+        return false;
+    }
+    for (size_t i = 0; i < batch.generations.size(); ++i) {
+        uint64_t hash = 0;
+        for (size_t g = 0; g < groups; ++g)
+            hash += batch.partials[i * groups + g];
+        lastGeneration = batch.generations[i];
+        lastHash = hash;
+        if (onHash(batch.generations[i], hash))
+            stop = true;
+    }
+    batch.generations.clear();
+    return true;
+}
+
+bool GameOfLife::evolveOpenCL(int generations, int snapshotInterval, const SnapshotCallback& onSnapshot,
+                              const HashCallback& onHash) {
+    if (!initializeOpenCL()) {
+        return false;
+    }
+    if (!syncDeviceGrid()) {
+        return false;
+    }
+    if (onHash && !hashKernel && !createHashKernel()) {
         return false;
     }
     
-    for (int i = 0; i < generations; i++) {
-        err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &currentBuffer);
-        err |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &nextBuffer);
+    cl_int err = CL_SUCCESS;
+    size_t gridBytes = deviceGridBytes();
+    size_t globalWorkSize[2] = { m_width, m_height };
+    const size_t* localSize = nullptr;
+    // Bit-packed storage has a single kernel, one work-item per word
+    KernelVariant variant = deviceVariant();
+    if (deviceStorage() == CellStorage::BitPacked)
+        globalWorkSize[0] = (m_width + 63) / 64;
+    if (variant == KernelVariant::Tiled) {
+        size_t tileH = localWorkSize[1] * tiledRowsPerItem;
+        globalWorkSize[0] = (m_width + localWorkSize[0] - 1) / localWorkSize[0] * localWorkSize[0];
+        globalWorkSize[1] = (m_height + tileH - 1) / tileH * localWorkSize[1];
+        localSize = localWorkSize;
+    } else if (variant == KernelVariant::TemporalBlocked) {
+        globalWorkSize[0] = (m_width + localWorkSize[0] - 1) / localWorkSize[0] * localWorkSize[0];
+        globalWorkSize[1] = (m_height + localWorkSize[1] - 1) / localWorkSize[1] * localWorkSize[1];
+        localSize = localWorkSize;
+    }
+
+    // Snapshots are read on transferQueue into two alternating host slots.
+    // pendingReads[i] guards gridBuffers[i] until its readback has finished,
+    // since the kernel two launches later overwrites it.
+    SnapshotSlot slots[2];
+    cl_event pendingReads[2] = { nullptr, nullptr };
+    std::vector<double>* snapshotSamples = m_profiling ? &m_readbackSamples : nullptr;
+    std::vector<cl_event> kernelEvents;
+    int snapshotCount = 0;
+    bool ok = true;
+    int gen = 0;
+
+    // With onHash, every launch is followed by a hash reduction into the
+    // filling half of hashBuffer. A full half is read back without blocking
+    // and reported once the other half fills, so the kernels keep running.
+    HashBatch hashBatches[2];
+    int hashReads = 0;
+    bool stopRequested = false;
+    int lastHashedGeneration = -1;
+    uint64_t lastHash = 0;
+    const cl_uint hashSlotArg = (deviceStorage() == CellStorage::BitPacked) ? 4 : 3;
+    auto readHashBatch = [&](HashBatch& batch) {
+        size_t half = static_cast<size_t>(hashReads % 2);
+        batch.partials.resize(batch.generations.size() * hashGroups);
+        err = clEnqueueReadBuffer(queue, hashBuffer, CL_FALSE, sizeof(cl_ulong) * half * hashBatchGenerations * hashGroups,
+                                  sizeof(cl_ulong) * batch.partials.size(), batch.partials.data(),
+                                  0, nullptr, &batch.readDone);
         if (err != CL_SUCCESS) {
-            std::cerr << "Failed to set kernel arguments for iteration." << std::endl;
-            if (currentBuffer) clReleaseMemObject(currentBuffer);
-            if (nextBuffer) clReleaseMemObject(nextBuffer);
+            std::cerr << "Failed to enqueue grid hash readback." << std::endl;
+            batch.readDone = nullptr;
             return false;
         }
-        
-        err = clEnqueueNDRangeKernel(queue, kernel, 2, nullptr, globalWorkSize, nullptr, 0, nullptr, nullptr);
+        clFlush(queue);
+        ++hashReads;
+        return true;
+    };
+
+    while (gen < generations && ok && !stopRequested) {
+        int src = currentBufferIndex;
+        int dst = 1 - src;
+
+        // A blocked launch covers several generations but never steps past
+        // the end of the run or the next snapshot
+        int step = 1;
+        if (variant == KernelVariant::TemporalBlocked) {
+            step = std::min(m_blockDepth, generations - gen);
+            if (snapshotInterval > 0)
+                step = std::min(step, snapshotInterval - gen % snapshotInterval);
+            cl_int depth = step;
+            clSetKernelArg(kernels[src], 4, sizeof(cl_int), &depth);
+        }
+        gen += step;
+
+        bool takeSnapshot = snapshotInterval > 0 && gen % snapshotInterval == 0;
+        cl_event kernelDone = nullptr;
+
+        err = clEnqueueNDRangeKernel(queue, kernels[src], 2, nullptr, globalWorkSize, localSize,
+                                     pendingReads[dst] ? 1 : 0,
+                                     pendingReads[dst] ? &pendingReads[dst] : nullptr,
+                                     (takeSnapshot || m_profiling) ? &kernelDone : nullptr);
         if (err != CL_SUCCESS) {
             std::cerr << "Failed to execute kernel." << std::endl;
-            if (currentBuffer) clReleaseMemObject(currentBuffer);
-            if (nextBuffer) clReleaseMemObject(nextBuffer);
-            return false;
+            ok = false;
+            break;
+        }
+        if (pendingReads[dst]) {
+            clReleaseEvent(pendingReads[dst]);
+            pendingReads[dst] = nullptr;
+        }
+        currentBufferIndex = dst;
+        m_hostStale = true;
+        m_sparseValid = false;
+        m_hashValid = false;
+        m_hashLifeValid = false;
+        m_generation += step;
+
+        if (m_profiling) {
+            clRetainEvent(kernelDone);
+            kernelEvents.push_back(kernelDone);
+            if (kernelEvents.size() >= maxPendingProfileEvents)
+                collectKernelEvents(kernelEvents, kernelEvents.size() / 2, m_kernelSamples);
+        }
+        if (onHash) {
+            HashBatch& batch = hashBatches[hashReads % 2];
+            cl_int slot = static_cast<cl_int>((hashReads % 2) * hashBatchGenerations + batch.generations.size());
+            size_t hashGlobalSize = hashGroups * hashGroupSize;
+            err = clSetKernelArg(hashKernel, 0, sizeof(cl_mem), &gridBuffers[dst]);
+            err |= clSetKernelArg(hashKernel, hashSlotArg, sizeof(cl_int), &slot);
+            err |= clEnqueueNDRangeKernel(queue, hashKernel, 1, nullptr, &hashGlobalSize, &hashGroupSize,
+                                          0, nullptr, nullptr);
+            if (err != CL_SUCCESS) {
+                std::cerr << "Failed to execute hash kernel." << std::endl;
+                if (kernelDone) clReleaseEvent(kernelDone);
+                ok = false;
+                break;
+            }
+            batch.generations.push_back(gen);
+            // The other half is reported before the next launch refills it
+            if (batch.generations.size() == hashBatchGenerations) {
+                ok = readHashBatch(batch)
+                  && deliverHashBatch(hashBatches[hashReads % 2], hashGroups, onHash,
+                                      stopRequested, lastHashedGeneration, lastHash);
+            }
         }
-        
-        clFinish(queue);
-        
-        cl_mem temp = currentBuffer;
-        currentBuffer = nextBuffer;
-        nextBuffer = temp;
+        if (!takeSnapshot) {
+            if (kernelDone) clReleaseEvent(kernelDone);
+            continue;
+        }
+
+        SnapshotSlot& slot = slots[snapshotCount % 2];
+        ok = deliverSnapshot(slot, onSnapshot, snapshotSamples);
+        slot.grid.resize(m_width * m_height);
+        slot.storage = deviceStorage();
+        slot.width = m_width;
+        slot.height = m_height;
+        slot.generation = gen;
+        void* readTarget = slot.grid.data();
+        if (deviceStorage() != CellStorage::Int) {
+            slot.raw.resize(gridBytes);
+            readTarget = slot.raw.data();
+        }
+
+        clFlush(queue);
+        err = clEnqueueReadBuffer(transferQueue, gridBuffers[dst], CL_FALSE, 0, gridBytes,
+                                  readTarget, 1, &kernelDone, &slot.readDone);
+        clReleaseEvent(kernelDone);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to enqueue snapshot readback." << std::endl;
+            slot.readDone = nullptr;
+            ok = false;
+            break;
+        }
+        clFlush(transferQueue);
+        clRetainEvent(slot.readDone);
+        pendingReads[dst] = slot.readDone;
+        ++snapshotCount;
     }
-    
-    err = clEnqueueReadBuffer(queue, currentBuffer, CL_TRUE, 0, sizeof(int) * gridSize, m_currentGrid.data(), 0, nullptr, nullptr);
-    if (err != CL_SUCCESS) {
-        std::cerr << "Failed to read back results." << std::endl;
-        if (currentBuffer) clReleaseMemObject(currentBuffer);
-        if (nextBuffer) clReleaseMemObject(nextBuffer);
-        return false;
+
+    // Deliver outstanding snapshots oldest first
+    for (int i = 0; i < 2; ++i) {
+        if (!deliverSnapshot(slots[(snapshotCount + i) % 2], onSnapshot, snapshotSamples))
+            ok = false;
     }
-    
-    if (currentBuffer) clReleaseMemObject(currentBuffer);
-    if (nextBuffer) clReleaseMemObject(nextBuffer);
-    currentBuffer = nextBuffer = nullptr;
-    
-    return true;
+    for (int i = 0; i < 2; ++i) {
+        if (pendingReads[i]) clReleaseEvent(pendingReads[i]);
+    }
+
+    // Report outstanding hashes oldest first, including a partly filled half
+    if (onHash) {
+        HashBatch& filling = hashBatches[hashReads % 2];
+        if (!filling.generations.empty() && !(ok && readHashBatch(filling))) {
+            filling.generations.clear();
+            ok = false;
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (!deliverHashBatch(hashBatches[(hashReads + i) % 2], hashGroups, onHash,
+                                  stopRequested, lastHashedGeneration, lastHash))
+                ok = false;
+        }
+        if (ok && lastHashedGeneration == gen) {
+            m_gridHash = lastHash;
+            m_hashValid = true;
+        }
+    }
+
+    clFinish(queue);
+    collectKernelEvents(kernelEvents, kernelEvents.size(), m_kernelSamples);
+    return ok;
 }
 
 inline size_t GameOfLife::cellIndex(size_t x, size_t y) const {
@@ -0,0 +1,452 @@
+#include "../include/HashLife.h"
+#include <algorithm>
+#include <stdexcept>
+
+// Leaves are the first two nodes: 0 is a dead cell, 1 a live one
+static const HashLife::NodeId deadLeaf = 0;
+static const HashLife::NodeId liveLeaf = 1;
+
+// Jumps stay below 2^61 generations and roots below level 63, so cell
+// coordinates fit in int64_t
+static const unsigned maxJumpLog = 60;
+
+static unsigned floorLog2(uint64_t value) {
+    unsigned log = 0;
+    while (value >>= 1)
+        ++log;
+    return log;
+}
+
+static unsigned trailingZeros(uint64_t value) {
+    unsigned zeros = 0;
+    while (value != 0 && (value & 1u) == 0) {
+        value >>= 1;
+        ++zeros;
+    }
+    return zeros;
+}
+
+// Distinct cell offsets, modulo a world side, of the 2^(rootLevel - level)
+// level-sized squares along one side of a root built by jumpFlat()
+static uint64_t distinctOffsets(uint64_t side, unsigned level, unsigned rootLevel) {
+    uint64_t residues = side >> std::min(level, trailingZeros(side));
+    uint64_t positions = uint64_t(1) << std::min(rootLevel - level, 62u);
+    return std::min(residues, positions);
+}
+
+HashLife::HashLife(size_t maxNodes, uint32_t birth, uint32_t survival)
+    : m_maxNodes(maxNodes), m_nodeLimit(SIZE_MAX), m_overBudget(false), m_birth(birth), m_survival(survival),
+      m_width(0), m_height(0), m_torusLevel(0), m_torus(deadLeaf), m_generation(0)
+{
+    reset();
+}
+
+void HashLife::reset() {
+    m_nodes.clear();
+    m_table.clear();
+    m_emptyNodes.clear();
+    m_nodes.push_back(Node{ deadLeaf, deadLeaf, deadLeaf, deadLeaf, deadLeaf, -1, 0, 0 });
+    m_nodes.push_back(Node{ deadLeaf, deadLeaf, deadLeaf, deadLeaf, deadLeaf, -1, 0, 1 });
+}
+
+void HashLife::load(const std::vector<int>& cells, size_t width, size_t height) {
+    if (width == 0 || height == 0 || cells.size() != width * height)
+        throw std::invalid_argument("HashLife::load: grid size mismatch.");
+
+    // Nodes and memoized results of earlier worlds stay in the cache and
+    // are reused wherever the new world repeats their contents
+    m_width = width;
+    m_height = height;
+    m_generation = 0;
+    m_torusLevel = 0;
+    m_cells.clear();
+    m_buildMemoLevels.clear();
+
+    // Square power-of-two tori stay in quadtree form between jumps
+    if (width == height && width >= 4 && (width & (width - 1)) == 0) {
+        m_torusLevel = floorLog2(width);
+        m_torus = build(cells, m_torusLevel, 0, 0);
+    } else {
+        m_cells.resize(cells.size());
+        for (size_t i = 0; i < cells.size(); ++i)
+            m_cells[i] = cells[i] != 0 ? 1 : 0;
+    }
+}
+
+void HashLife::store(std::vector<int>& cells) const {
+    if (m_torusLevel == 0) {
+        cells = m_cells;
+        return;
+    }
+    cells.assign(m_width * m_height, 0);
+    flatten(m_torus, 0, 0, cells);
+}
+
+HashLife::NodeId HashLife::join(NodeId nw, NodeId ne, NodeId sw, NodeId se) {
+    Key key{ nw, ne, sw, se };
+    auto it = m_table.find(key);
+    if (it != m_table.end())
+        return it->second;
+
+    Node node;
+    node.nw = nw;
+    node.ne = ne;
+    node.sw = sw;
+    node.se = se;
+    node.result = deadLeaf;
+    node.resultStep = -1;
+    node.level = m_nodes[nw].level + 1;
+    // Saturates instead of wrapping, so the huge periodic roots of long
+    // jumps never look empty
+    node.population = 0;
+    for (NodeId child : { nw, ne, sw, se })
+        node.population += std::min(m_nodes[child].population, UINT64_MAX - node.population);
+
+    NodeId id = static_cast<NodeId>(m_nodes.size());
+    m_nodes.push_back(node);
+    m_table.emplace(key, id);
+    if (m_nodes.size() > m_nodeLimit)
+        m_overBudget = true;
+    return id;
+}
+
+HashLife::NodeId HashLife::empty(unsigned level) {
+    if (level == 0)
+        return deadLeaf;
+    if (m_emptyNodes.size() < level + 1)
+        m_emptyNodes.resize(level + 1, deadLeaf);
+    if (m_emptyNodes[level] == deadLeaf) {
+        NodeId child = empty(level - 1);
+        m_emptyNodes[level] = join(child, child, child, child);
+    }
+    return m_emptyNodes[level];
+}
+
+HashLife::NodeId HashLife::centre(NodeId n) {
+    const Node node = m_nodes[n];
+    return join(m_nodes[node.nw].se, m_nodes[node.ne].sw, m_nodes[node.sw].ne, m_nodes[node.se].nw);
+}
+
+// Level-2 node (4x4 cells) to its 2x2 centre one generation later
+HashLife::NodeId HashLife::baseStep(NodeId n) {
+    int grid[4][4];
+    const Node node = m_nodes[n];
+    const NodeId quadrants[4] = { node.nw, node.ne, node.sw, node.se };
+    for (int q = 0; q < 4; ++q) {
+        const Node& quad = m_nodes[quadrants[q]];
+        int x0 = (q % 2) * 2;
+        int y0 = (q / 2) * 2;
+        grid[y0][x0] = static_cast<int>(m_nodes[quad.nw].population);
+        grid[y0][x0 + 1] = static_cast<int>(m_nodes[quad.ne].population);
+        grid[y0 + 1][x0] = static_cast<int>(m_nodes[quad.sw].population);
+        grid[y0 + 1][x0 + 1] = static_cast<int>(m_nodes[quad.se].population);
+    }
+
+    NodeId next[2][2];
+    for (int y = 1; y <= 2; ++y) {
+        for (int x = 1; x <= 2; ++x) {
+            int neighbors = grid[y - 1][x - 1] + grid[y - 1][x] + grid[y - 1][x + 1]
+                          + grid[y][x - 1] + grid[y][x + 1]
+                          + grid[y + 1][x - 1] + grid[y + 1][x] + grid[y + 1][x + 1];
+            bool alive = (((grid[y][x] ? m_survival : m_birth) >> neighbors) & 1u) != 0;
+            next[y - 1][x - 1] = alive ? liveLeaf : deadLeaf;
+        }
+    }
+    return join(next[0][0], next[0][1], next[1][0], next[1][1]);
+}
+
+// Centre half of node n advanced 2^k generations; requires k <= level - 2
+HashLife::NodeId HashLife::step(NodeId n, unsigned k) {
+    // The jump is abandoned once over budget; nothing more is computed
+    if (m_overBudget)
+        return deadLeaf;
+    const Node node = m_nodes[n];
+    if (node.population == 0)
+        return empty(node.level - 1);
+    if (node.resultStep == static_cast<int>(k))
+        return node.result;
+
+    NodeId result;
+    if (node.level == 2) {
+        result = baseStep(n);
+    } else {
+        const Node a = m_nodes[node.nw];
+        const Node b = m_nodes[node.ne];
+        const Node c = m_nodes[node.sw];
+        const Node d = m_nodes[node.se];
+
+        // Nine overlapping sub-squares one level down
+        NodeId n00 = node.nw;
+        NodeId n01 = join(a.ne, b.nw, a.se, b.sw);
+        NodeId n02 = node.ne;
+        NodeId n10 = join(a.sw, a.se, c.nw, c.ne);
+        NodeId n11 = join(a.se, b.sw, c.ne, d.nw);
+        NodeId n12 = join(b.sw, b.se, d.nw, d.ne);
+        NodeId n20 = node.sw;
+        NodeId n21 = join(c.ne, d.nw, c.se, d.sw);
+        NodeId n22 = node.se;
+
+        NodeId r00, r01, r02, r10, r11, r12, r20, r21, r22;
+        unsigned innerStep;
+        if (k + 2 == node.level) {
+            // Full speed: two half-length steps
+            innerStep = k - 1;
+            r00 = step(n00, innerStep); r01 = step(n01, innerStep); r02 = step(n02, innerStep);
+            r10 = step(n10, innerStep); r11 = step(n11, innerStep); r12 = step(n12, innerStep);
+            r20 = step(n20, innerStep); r21 = step(n21, innerStep); r22 = step(n22, innerStep);
+        } else {
+            // Shorter step: take the centres now, spend all k on the second pass
+            innerStep = k;
+            r00 = centre(n00); r01 = centre(n01); r02 = centre(n02);
+            r10 = centre(n10); r11 = centre(n11); r12 = centre(n12);
+            r20 = centre(n20); r21 = centre(n21); r22 = centre(n22);
+        }
+
+        NodeId resultNw = step(join(r00, r01, r10, r11), innerStep);
+        NodeId resultNe = step(join(r01, r02, r11, r12), innerStep);
+        NodeId resultSw = step(join(r10, r11, r20, r21), innerStep);
+        NodeId resultSe = step(join(r11, r12, r21, r22), innerStep);
+        result = join(resultNw, resultNe, resultSw, resultSe);
+    }
+
+    if (!m_overBudget) {
+        m_nodes[n].result = result;
+        m_nodes[n].resultStep = static_cast<int>(k);
+    }
+    return result;
+}
+
+// Square of side 2^level with its top-left corner at (x0, y0) of the
+// periodic extension of the flat world. On levels flagged in
+// m_buildMemoLevels many squares start at the same offset modulo the world
+// size, so each offset is built once.
+HashLife::NodeId HashLife::build(const std::vector<int>& cells, unsigned level, int64_t x0, int64_t y0) {
+    int64_t w = static_cast<int64_t>(m_width);
+    int64_t h = static_cast<int64_t>(m_height);
+    uint64_t x = static_cast<uint64_t>((x0 % w + w) % w);
+    uint64_t y = static_cast<uint64_t>((y0 % h + h) % h);
+    if (level == 0)
+        return cells[y * m_width + x] != 0 ? liveLeaf : deadLeaf;
+
+    bool memoize = level < m_buildMemoLevels.size() && m_buildMemoLevels[level];
+    BuildKey key{ level, x, y };
+    if (memoize) {
+        auto it = m_buildMemo.find(key);
+        if (it != m_buildMemo.end())
+            return it->second;
+    }
+    int64_t half = int64_t(1) << (level - 1);
+    NodeId nw = build(cells, level - 1, x0, y0);
+    NodeId ne = build(cells, level - 1, x0 + half, y0);
+    NodeId sw = build(cells, level - 1, x0, y0 + half);
+    NodeId se = build(cells, level - 1, x0 + half, y0 + half);
+    NodeId node = join(nw, ne, sw, se);
+    if (memoize)
+        m_buildMemo.emplace(key, node);
+    return node;
+}
+
+// Writes the live cells of node n, placed at (x0, y0), that fall inside the world
+void HashLife::flatten(NodeId n, int64_t x0, int64_t y0, std::vector<int>& cells) const {
+    const Node& node = m_nodes[n];
+    int64_t size = int64_t(1) << node.level;
+    if (node.population == 0 || x0 >= static_cast<int64_t>(m_width) || y0 >= static_cast<int64_t>(m_height)
+        || x0 + size <= 0 || y0 + size <= 0)
+        return;
+    if (node.level == 0) {
+        cells[static_cast<size_t>(y0) * m_width + static_cast<size_t>(x0)] = 1;
+        return;
+    }
+    int64_t half = size / 2;
+    flatten(node.nw, x0, y0, cells);
+    flatten(node.ne, x0 + half, y0, cells);
+    flatten(node.sw, x0, y0 + half, cells);
+    flatten(node.se, x0 + half, y0 + half, cells);
+}
+
+// Nodes a jumpFlat() root of the given level is built from, counted as
+// distinct offsets per level (see build())
+uint64_t HashLife::flatBuildNodes(unsigned rootLevel) const {
+    uint64_t nodes = 0;
+    for (unsigned level = 1; level <= rootLevel; ++level)
+        nodes += distinctOffsets(m_width, level, rootLevel) * distinctOffsets(m_height, level, rootLevel);
+    return nodes;
+}
+
+// Longest jump (log2) for worlds that are not quadtree-resident. Any root
+// whose centre covers the world works, and a larger root allows a longer
+// jump; the root is grown while building it stays within half the node
+// budget. Sides with many factors of two repeat after few offsets, so
+// small or even-sized worlds reach the maximum jump, while a large world
+// with odd sides stays near its smallest root, about one side length of
+// generations per rebuild.
+unsigned HashLife::maxFlatJump() const {
+    unsigned level = 2;
+    while ((uint64_t(1) << (level - 1)) < std::max(m_width, m_height))
+        ++level;
+    while (level < maxJumpLog + 2 && flatBuildNodes(level + 1) <= m_maxNodes / 2)
+        ++level;
+    return level - 2;
+}
+
+// One jump of 2^k generations for worlds that are not quadtree-resident:
+// build a node whose centre covers the world, step it and flatten back.
+// False if the jump went over the node budget.
+bool HashLife::jumpFlat(unsigned k) {
+    unsigned level = 2;
+    while ((uint64_t(1) << (level - 1)) < std::max(m_width, m_height) || level < k + 2)
+        ++level;
+    int64_t offset = int64_t(1) << (level - 2);
+
+    m_buildMemoLevels.assign(level + 1, 0);
+    for (unsigned l = 1; l <= level; ++l) {
+        uint64_t positions = uint64_t(1) << std::min(level - l, 62u);
+        m_buildMemoLevels[l] = distinctOffsets(m_width, l, level) < positions
+                            || distinctOffsets(m_height, l, level) < positions;
+    }
+    NodeId root = build(m_cells, level, -offset, -offset);
+    m_buildMemo.clear();
+    m_buildMemoLevels.clear();
+
+    NodeId result = step(root, k);
+    if (m_overBudget)
+        return false;
+    std::vector<int> next(m_width * m_height, 0);
+    flatten(result, 0, 0, next);
+    m_cells.swap(next);
+    return true;
+}
+
+// One jump of 2^k generations of a quadtree-resident torus. Copies of the
+// torus tile a root one level up or large enough for the jump; its result
+// starts half a torus side from the origin when the root is one level up
+// (undone by swapping quadrants) and a whole number of sides otherwise.
+bool HashLife::jumpTorus(unsigned k) {
+    NodeId root = m_torus;
+    unsigned level = m_torusLevel;
+    while (level < m_torusLevel + 1 || level < k + 2) {
+        root = join(root, root, root, root);
+        ++level;
+    }
+    NodeId result = step(root, k);
+    if (m_overBudget)
+        return false;
+
+    if (level == m_torusLevel + 1) {
+        const Node shifted = m_nodes[result];
+        m_torus = join(shifted.se, shifted.sw, shifted.ne, shifted.nw);
+    } else {
+        while (m_nodes[result].level > m_torusLevel)
+            result = m_nodes[result].nw;
+        m_torus = result;
+    }
+    return true;
+}
+
+void HashLife::advance(uint64_t generations) {
+    unsigned maxK = m_torusLevel >= 2 ? maxJumpLog : std::min(maxJumpLog, maxFlatJump());
+    while (generations > 0) {
+        unsigned k = std::min(floorLog2(generations), maxK);
+
+        // A jump may grow the cache to the node budget (or twice what
+        // survives collection, for worlds larger than the budget). A jump
+        // that goes over is abandoned, the cache is collected and the
+        // remaining generations are taken in shorter jumps. A single
+        // generation always completes.
+        if (m_nodes.size() > m_maxNodes)
+            collectGarbage();
+        m_nodeLimit = k == 0 ? SIZE_MAX : std::max(m_maxNodes, 2 * m_nodes.size());
+        m_overBudget = false;
+        bool done = m_torusLevel >= 2 ? jumpTorus(k) : jumpFlat(k);
+        m_nodeLimit = SIZE_MAX;
+        if (!done) {
+            m_overBudget = false;
+            collectGarbage();
+            maxK = k - 1;
+            continue;
+        }
+
+        generations -= uint64_t(1) << k;
+        m_generation += uint64_t(1) << k;
+    }
+    if (m_nodes.size() > m_maxNodes)
+        collectGarbage();
+}
+
+void HashLife::setMaxNodes(size_t maxNodes) {
+    m_maxNodes = maxNodes;
+}
+
+size_t HashLife::getMaxNodes() const {
+    return m_maxNodes;
+}
+
+bool HashLife::hasRule(uint32_t birth, uint32_t survival) const {
+    return birth == m_birth && survival == m_survival;
+}
+
+// Keeps only the nodes reachable from the current world and drops every
+// memoized result, bringing the cache back under its node budget
+void HashLife::collectGarbage() {
+    if (m_torusLevel < 2) {
+        reset();
+        return;
+    }
+
+    std::vector<char> live(m_nodes.size(), 0);
+    live[deadLeaf] = live[liveLeaf] = 1;
+    std::vector<NodeId> stack(1, m_torus);
+    while (!stack.empty()) {
+        NodeId n = stack.back();
+        stack.pop_back();
+        if (live[n])
+            continue;
+        live[n] = 1;
+        const Node& node = m_nodes[n];
+        stack.push_back(node.nw);
+        stack.push_back(node.ne);
+        stack.push_back(node.sw);
+        stack.push_back(node.se);
+    }
+
+    // Children always have smaller ids than their parents, so one pass in
+    // id order can compact the vector and remap child links
+    std::vector<NodeId> remap(m_nodes.size(), deadLeaf);
+    std::vector<Node> kept;
+    kept.reserve(m_nodes.size());
+    m_table.clear();
+    for (NodeId n = 0; n < m_nodes.size(); ++n) {
+        if (!live[n])
+            continue;
+        Node node = m_nodes[n];
+        NodeId id = static_cast<NodeId>(kept.size());
+        remap[n] = id;
+        if (node.level > 0) {
+            node.nw = remap[node.nw];
+            node.ne = remap[node.ne];
+            node.sw = remap[node.sw];
+            node.se = remap[node.se];
+            m_table.emplace(Key{ node.nw, node.ne, node.sw, node.se }, id);
+        }
+        node.result = deadLeaf;
+        node.resultStep = -1;
+        kept.push_back(node);
+    }
+    m_nodes.swap(kept);
+    m_torus = remap[m_torus];
+    m_emptyNodes.clear();
+}
+
+uint64_t HashLife::population() const {
+    if (m_torusLevel == 0)
+        return static_cast<uint64_t>(std::count(m_cells.begin(), m_cells.end(), 1));
+    return m_nodes[m_torus].population;
+}
+
+size_t HashLife::nodeCount() const {
+    return m_nodes.size();
+}
+
+uint64_t HashLife::getGeneration() const {
+    return m_generation;
+}
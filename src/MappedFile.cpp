@@ -0,0 +1,176 @@
+#include "../include/MappedFile.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0), m_writable(false), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+{
+}
+
+void MappedFile::openRead(const std::string& filename) {
+    close();
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open file: " + filename);
+    m_file = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        throw std::runtime_error("Cannot map empty or unreadable file: " + filename);
+    }
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        close();
+        throw std::runtime_error("Failed to map file: " + filename);
+    }
+    m_data = static_cast<unsigned char*>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    m_writable = false;
+}
+
+void MappedFile::create(const std::string& filename, size_t size) {
+    close();
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Could not open file for writing: " + filename);
+    m_file = file;
+
+    ULARGE_INTEGER mappingSize;
+    mappingSize.QuadPart = size;
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                   mappingSize.HighPart, mappingSize.LowPart, nullptr);
+    void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, size) : nullptr;
+    if (!view) {
+        close();
+        throw std::runtime_error("Failed to map file for writing: " + filename);
+    }
+    m_data = static_cast<unsigned char*>(view);
+    m_size = size;
+    m_writable = true;
+}
+
+void MappedFile::flush() {
+    if (m_data && m_writable) {
+        if (!FlushViewOfFile(m_data, m_size) || !FlushFileBuffers(static_cast<HANDLE>(m_file)))
+            throw std::runtime_error("Failed to flush mapped file.");
+    }
+}
+
+void MappedFile::close() {
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(static_cast<HANDLE>(m_file));
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0), m_writable(false), m_fd(-1)
+{
+}
+
+void MappedFile::openRead(const std::string& filename) {
+    close();
+    m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (m_fd < 0)
+        throw std::runtime_error("Failed to open file: " + filename);
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0 || info.st_size == 0) {
+        close();
+        throw std::runtime_error("Cannot map empty or unreadable file: " + filename);
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, m_fd, 0);
+    if (view == MAP_FAILED) {
+        close();
+        throw std::runtime_error("Failed to map file: " + filename);
+    }
+    m_data = static_cast<unsigned char*>(view);
+    m_size = static_cast<size_t>(info.st_size);
+    m_writable = false;
+    madvise(view, m_size, MADV_SEQUENTIAL);
+}
+
+void MappedFile::create(const std::string& filename, size_t size) {
+    close();
+    m_fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+        throw std::runtime_error("Could not open file for writing: " + filename);
+
+    if (ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+        close();
+        throw std::runtime_error("Failed to size file: " + filename);
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (view == MAP_FAILED) {
+        close();
+        throw std::runtime_error("Failed to map file for writing: " + filename);
+    }
+    m_data = static_cast<unsigned char*>(view);
+    m_size = size;
+    m_writable = true;
+}
+
+void MappedFile::flush() {
+    if (m_data && m_writable) {
+        if (msync(m_data, m_size, MS_SYNC) != 0)
+            throw std::runtime_error("Failed to flush mapped file.");
+    }
+}
+
+void MappedFile::close() {
+    if (m_data)
+        munmap(m_data, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::isOpen() const {
+    return m_data != nullptr;
+}
+
+const unsigned char* MappedFile::data() const {
+    return m_data;
+}
+
+unsigned char* MappedFile::data() {
+    return m_data;
+}
+
+size_t MappedFile::size() const {
+    return m_size;
+}
@@ -0,0 +1,409 @@
+#include "../include/MultiDevice.h"
+#include "../include/OpenCLDevice.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+static const char* stripKernelSource = R"CLC(
+// Evolves rows rowBegin .. rowBegin + get_global_size(1) - 1 of a strip of
+// `rows` rows. halo holds the row above the strip followed by the row
+// below it. The new first and last rows are also copied to edges. ALIVE
+// and NEXT_STATE come from the rule macros prepended to this source.
+__kernel void evolveStrip(__global const int* current,
+                          __global const int* halo,
+                          __global int* next,
+                          __global int* edges,
+                          int width,
+                          int rows,
+                          int rowBegin)
+{
+    int x = get_global_id(0);
+    int y = rowBegin + get_global_id(1);
+
+    __global const int* up = (y == 0) ? halo : current + (y - 1) * width;
+    __global const int* mid = current + y * width;
+    __global const int* down = (y == rows - 1) ? halo + width : current + (y + 1) * width;
+    int left = (x == 0) ? width - 1 : x - 1;
+    int right = (x + 1 == width) ? 0 : x + 1;
+    int count = ALIVE(up[left]) + ALIVE(up[x]) + ALIVE(up[right])
+              + ALIVE(mid[left]) + ALIVE(mid[right])
+              + ALIVE(down[left]) + ALIVE(down[x]) + ALIVE(down[right]);
+
+    int nextState = NEXT_STATE(mid[x], count);
+    next[y * width + x] = nextState;
+    if (y == 0)
+        edges[x] = nextState;
+    if (y == rows - 1)
+        edges[width + x] = nextState;
+}
+)CLC";
+
+MultiDeviceLife::MultiDeviceLife(size_t width, size_t height, const Rule& rule)
+    : m_width(width), m_height(height), m_rule(rule), m_current(0)
+{
+}
+
+MultiDeviceLife::~MultiDeviceLife() {
+    cleanup();
+}
+
+bool MultiDeviceLife::initialize(const std::string& devices, unsigned subDevices) {
+    cleanup();
+    if (m_rule.isLargerThanLife()) {
+        // Halos are one row deep
+        std::cerr << "The multi-device engine does not support Larger than Life rules." << std::endl;
+        return false;
+    }
+
+    std::vector<OpenCLDeviceInfo> available = listOpenCLDevices();
+    if (available.empty()) {
+        std::cerr << "No OpenCL devices found." << std::endl;
+        return false;
+    }
+
+    std::vector<size_t> selected;
+    if (devices.empty() || devices == "all") {
+        for (const OpenCLDeviceInfo& info : available)
+            selected.push_back(info.index);
+    } else {
+        std::istringstream list(devices);
+        std::string selector;
+        while (std::getline(list, selector, ',')) {
+            size_t index = 0;
+            if (!findOpenCLDevice(available, selector, index)) {
+                std::cerr << "No OpenCL device matches '" << selector << "'." << std::endl;
+                return false;
+            }
+            if (std::find(selected.begin(), selected.end(), index) == selected.end())
+                selected.push_back(index);
+        }
+    }
+
+    for (size_t index : selected) {
+        const OpenCLDeviceInfo& info = available[index];
+        std::vector<cl_device_id> parts;
+        if (subDevices > 1) {
+            cl_uint unitsPerPart = std::max<cl_uint>(1, info.computeUnits / subDevices);
+            cl_device_partition_property properties[] = {
+                CL_DEVICE_PARTITION_EQUALLY, static_cast<cl_device_partition_property>(unitsPerPart), 0
+            };
+            cl_uint count = 0;
+            if (clCreateSubDevices(info.id, properties, 0, nullptr, &count) == CL_SUCCESS && count > 1) {
+                parts.resize(count);
+                if (clCreateSubDevices(info.id, properties, count, parts.data(), nullptr) != CL_SUCCESS)
+                    parts.clear();
+            }
+            // Equal partitions can outnumber the request; keep the first ones
+            while (parts.size() > subDevices) {
+                clReleaseDevice(parts.back());
+                parts.pop_back();
+            }
+        }
+
+        if (parts.empty()) {
+            Strip strip;
+            strip.device = info.id;
+            strip.name = info.name;
+            strip.computeUnits = std::max<cl_uint>(1, info.computeUnits);
+            m_strips.push_back(strip);
+            continue;
+        }
+        for (size_t p = 0; p < parts.size(); ++p) {
+            Strip strip;
+            strip.device = parts[p];
+            strip.subDevice = true;
+            strip.name = info.name + " #" + std::to_string(p);
+            clGetDeviceInfo(parts[p], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &strip.computeUnits, nullptr);
+            strip.computeUnits = std::max<cl_uint>(1, strip.computeUnits);
+            m_strips.push_back(strip);
+        }
+    }
+
+    // Every strip needs at least one row
+    while (m_strips.size() > m_height) {
+        if (m_strips.back().subDevice)
+            clReleaseDevice(m_strips.back().device);
+        m_strips.pop_back();
+    }
+
+    // One row each, the rest in proportion to compute units
+    cl_uint totalUnits = 0;
+    for (const Strip& strip : m_strips)
+        totalUnits += strip.computeUnits;
+    size_t spare = m_height - m_strips.size();
+    size_t row = 0;
+    cl_uint unitsBefore = 0;
+    for (Strip& strip : m_strips) {
+        size_t spareBefore = spare * unitsBefore / totalUnits;
+        unitsBefore += strip.computeUnits;
+        size_t spareAfter = spare * unitsBefore / totalUnits;
+        strip.rowBegin = row;
+        strip.rows = 1 + spareAfter - spareBefore;
+        row += strip.rows;
+    }
+
+    for (Strip& strip : m_strips) {
+        if (!createStrip(strip)) {
+            cleanup();
+            return false;
+        }
+    }
+    m_current = 0;
+    return true;
+}
+
+bool MultiDeviceLife::createStrip(Strip& strip) {
+    cl_int err = CL_SUCCESS;
+    strip.context = clCreateContext(nullptr, 1, &strip.device, nullptr, nullptr, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create OpenCL context for " << strip.name << "." << std::endl;
+        strip.context = nullptr;
+        return false;
+    }
+
+    strip.computeQueue = clCreateCommandQueue(strip.context, strip.device, 0, &err);
+    if (err == CL_SUCCESS)
+        strip.transferQueue = clCreateCommandQueue(strip.context, strip.device, 0, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create command queues for " << strip.name << "." << std::endl;
+        return false;
+    }
+
+    std::string kernelSource = std::string(ruleKernelMacros()) + stripKernelSource;
+    std::string buildOptions = ruleBuildOptions(m_rule);
+    const char* source = kernelSource.c_str();
+    size_t sourceSize = kernelSource.size();
+    strip.program = clCreateProgramWithSource(strip.context, 1, &source, &sourceSize, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create program." << std::endl;
+        strip.program = nullptr;
+        return false;
+    }
+    err = clBuildProgram(strip.program, 1, &strip.device, buildOptions.c_str(), nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        size_t logSize;
+        clGetProgramBuildInfo(strip.program, strip.device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
+        std::string buildLog(logSize, ' ');
+        clGetProgramBuildInfo(strip.program, strip.device, CL_PROGRAM_BUILD_LOG, logSize, &buildLog[0], nullptr);
+        std::cerr << "Build error:\n" << buildLog << std::endl;
+        return false;
+    }
+
+    size_t rowBytes = sizeof(int) * m_width;
+    for (int i = 0; i < 2; ++i) {
+        strip.cells[i] = clCreateBuffer(strip.context, CL_MEM_READ_WRITE, rowBytes * strip.rows, nullptr, &err);
+        if (err == CL_SUCCESS)
+            strip.halos[i] = clCreateBuffer(strip.context, CL_MEM_READ_WRITE, 2 * rowBytes, nullptr, &err);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to create strip buffers." << std::endl;
+            return false;
+        }
+    }
+    strip.edges = clCreateBuffer(strip.context, CL_MEM_READ_WRITE, 2 * rowBytes, nullptr, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create strip buffers." << std::endl;
+        strip.edges = nullptr;
+        return false;
+    }
+
+    cl_int width = static_cast<cl_int>(m_width);
+    cl_int rows = static_cast<cl_int>(strip.rows);
+    for (int i = 0; i < 2; ++i) {
+        strip.kernels[i] = clCreateKernel(strip.program, "evolveStrip", &err);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to create kernel." << std::endl;
+            strip.kernels[i] = nullptr;
+            return false;
+        }
+        err = clSetKernelArg(strip.kernels[i], 0, sizeof(cl_mem), &strip.cells[i]);
+        err |= clSetKernelArg(strip.kernels[i], 1, sizeof(cl_mem), &strip.halos[i]);
+        err |= clSetKernelArg(strip.kernels[i], 2, sizeof(cl_mem), &strip.cells[1 - i]);
+        err |= clSetKernelArg(strip.kernels[i], 3, sizeof(cl_mem), &strip.edges);
+        err |= clSetKernelArg(strip.kernels[i], 4, sizeof(cl_int), &width);
+        err |= clSetKernelArg(strip.kernels[i], 5, sizeof(cl_int), &rows);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to set kernel arguments." << std::endl;
+            return false;
+        }
+    }
+
+    strip.hostEdges[0].resize(2 * m_width);
+    strip.hostEdges[1].resize(2 * m_width);
+    return true;
+}
+
+bool MultiDeviceLife::upload(const std::vector<int>& cells) {
+    if (m_strips.empty() || cells.size() != m_width * m_height)
+        return false;
+
+    size_t rowBytes = sizeof(int) * m_width;
+    for (Strip& strip : m_strips) {
+        releaseEvents(strip);
+        const int* above = cells.data() + ((strip.rowBegin + m_height - 1) % m_height) * m_width;
+        const int* below = cells.data() + ((strip.rowBegin + strip.rows) % m_height) * m_width;
+        cl_int err = clEnqueueWriteBuffer(strip.transferQueue, strip.cells[m_current], CL_FALSE, 0,
+                                          rowBytes * strip.rows, cells.data() + strip.rowBegin * m_width,
+                                          0, nullptr, nullptr);
+        err |= clEnqueueWriteBuffer(strip.transferQueue, strip.halos[m_current], CL_FALSE, 0, rowBytes,
+                                    above, 0, nullptr, nullptr);
+        err |= clEnqueueWriteBuffer(strip.transferQueue, strip.halos[m_current], CL_FALSE, rowBytes, rowBytes,
+                                    below, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to upload strip." << std::endl;
+            return false;
+        }
+    }
+    for (Strip& strip : m_strips)
+        clFinish(strip.transferQueue);
+    return true;
+}
+
+bool MultiDeviceLife::enqueueStripRows(Strip& strip, int rowBegin, size_t rowCount, cl_event* done) {
+    cl_kernel kernel = strip.kernels[m_current];
+    cl_event& haloReady = strip.haloWritten[m_current];
+    size_t globalWorkSize[2] = { m_width, rowCount };
+    cl_int err = clSetKernelArg(kernel, 6, sizeof(cl_int), &rowBegin);
+    err |= clEnqueueNDRangeKernel(strip.computeQueue, kernel, 2, nullptr, globalWorkSize, nullptr,
+                                  haloReady ? 1 : 0, haloReady ? &haloReady : nullptr, done);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to execute strip kernel." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MultiDeviceLife::evolve(int generations) {
+    const size_t count = m_strips.size();
+    if (count == 0)
+        return false;
+
+    size_t rowBytes = sizeof(int) * m_width;
+    std::vector<cl_event> edgesRead(count, nullptr);
+    bool ok = true;
+
+    for (int gen = 0; gen < generations && ok; ++gen) {
+        int next = 1 - m_current;
+        int parity = gen % 2;
+
+        // Edge rows first, so their readback overlaps the interior rows
+        for (size_t s = 0; s < count && ok; ++s) {
+            Strip& strip = m_strips[s];
+            cl_event edgesDone = nullptr;
+            if (strip.rows > 1)
+                ok = enqueueStripRows(strip, 0, 1, nullptr);
+            ok = ok && enqueueStripRows(strip, static_cast<int>(strip.rows) - 1, 1, &edgesDone);
+            if (ok && strip.rows > 2)
+                ok = enqueueStripRows(strip, 1, strip.rows - 2, nullptr);
+            clFlush(strip.computeQueue);
+            if (!ok)
+                break;
+
+            cl_int err = clEnqueueReadBuffer(strip.transferQueue, strip.edges, CL_FALSE, 0, 2 * rowBytes,
+                                             strip.hostEdges[parity].data(), 1, &edgesDone, &edgesRead[s]);
+            clReleaseEvent(edgesDone);
+            clFlush(strip.transferQueue);
+            if (err != CL_SUCCESS) {
+                std::cerr << "Failed to read strip edges." << std::endl;
+                edgesRead[s] = nullptr;
+                ok = false;
+            }
+        }
+
+        for (size_t s = 0; s < count; ++s) {
+            if (!edgesRead[s])
+                continue;
+            if (clWaitForEvents(1, &edgesRead[s]) != CL_SUCCESS)
+                ok = false;
+            clReleaseEvent(edgesRead[s]);
+            edgesRead[s] = nullptr;
+        }
+        if (!ok)
+            break;
+
+        // The last row of the strip above and the first row of the strip
+        // below become the halo of the next generation
+        for (size_t s = 0; s < count; ++s) {
+            Strip& strip = m_strips[s];
+            const Strip& above = m_strips[(s + count - 1) % count];
+            const Strip& below = m_strips[(s + 1) % count];
+            if (strip.haloWritten[next]) {
+                clReleaseEvent(strip.haloWritten[next]);
+                strip.haloWritten[next] = nullptr;
+            }
+            cl_int err = clEnqueueWriteBuffer(strip.transferQueue, strip.halos[next], CL_FALSE, 0, rowBytes,
+                                              above.hostEdges[parity].data() + m_width, 0, nullptr, nullptr);
+            err |= clEnqueueWriteBuffer(strip.transferQueue, strip.halos[next], CL_FALSE, rowBytes, rowBytes,
+                                        below.hostEdges[parity].data(), 0, nullptr, &strip.haloWritten[next]);
+            clFlush(strip.transferQueue);
+            if (err != CL_SUCCESS) {
+                std::cerr << "Failed to write strip halo." << std::endl;
+                ok = false;
+            }
+        }
+        m_current = next;
+    }
+
+    for (Strip& strip : m_strips) {
+        clFinish(strip.computeQueue);
+        clFinish(strip.transferQueue);
+    }
+    return ok;
+}
+
+bool MultiDeviceLife::download(std::vector<int>& cells) {
+    cells.resize(m_width * m_height);
+    bool ok = true;
+    for (Strip& strip : m_strips) {
+        cl_int err = clEnqueueReadBuffer(strip.transferQueue, strip.cells[m_current], CL_FALSE, 0,
+                                         sizeof(int) * m_width * strip.rows,
+                                         cells.data() + strip.rowBegin * m_width, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS) {
+            std::cerr << "Failed to read back strip." << std::endl;
+            ok = false;
+        }
+    }
+    for (Strip& strip : m_strips)
+        clFinish(strip.transferQueue);
+    return ok;
+}
+
+size_t MultiDeviceLife::stripCount() const {
+    return m_strips.size();
+}
+
+std::vector<std::string> MultiDeviceLife::describeStrips() const {
+    std::vector<std::string> lines;
+    for (const Strip& strip : m_strips)
+        lines.push_back(strip.name + ": rows " + std::to_string(strip.rowBegin) + "-"
+                        + std::to_string(strip.rowBegin + strip.rows - 1));
+    return lines;
+}
+
+void MultiDeviceLife::releaseEvents(Strip& strip) {
+    for (int i = 0; i < 2; ++i) {
+        if (strip.haloWritten[i]) clReleaseEvent(strip.haloWritten[i]);
+        strip.haloWritten[i] = nullptr;
+    }
+}
+
+void MultiDeviceLife::cleanup() {
+    for (Strip& strip : m_strips) {
+        if (strip.computeQueue) clFinish(strip.computeQueue);
+        if (strip.transferQueue) clFinish(strip.transferQueue);
+        releaseEvents(strip);
+        for (int i = 0; i < 2; ++i) {
+            if (strip.kernels[i]) clReleaseKernel(strip.kernels[i]);
+            if (strip.cells[i]) clReleaseMemObject(strip.cells[i]);
+            if (strip.halos[i]) clReleaseMemObject(strip.halos[i]);
+        }
+        if (strip.edges) clReleaseMemObject(strip.edges);
+        if (strip.program) clReleaseProgram(strip.program);
+        if (strip.transferQueue) clReleaseCommandQueue(strip.transferQueue);
+        if (strip.computeQueue) clReleaseCommandQueue(strip.computeQueue);
+        if (strip.context) clReleaseContext(strip.context);
+        if (strip.subDevice) clReleaseDevice(strip.device);
+    }
+    m_strips.clear();
+    m_current = 0;
+}
@@ -0,0 +1,114 @@
+#include "../include/OpenCLDevice.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+static std::string platformString(cl_platform_id platform, cl_platform_info param) {
+    size_t size = 0;
+    if (clGetPlatformInfo(platform, param, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+        return std::string();
+    std::string value(size, '\0');
+    clGetPlatformInfo(platform, param, size, &value[0], nullptr);
+    value.resize(std::strlen(value.c_str()));
+    return value;
+}
+
+std::string openclDeviceString(cl_device_id device, cl_device_info param) {
+    size_t size = 0;
+    if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0)
+        return std::string();
+    std::string value(size, '\0');
+    clGetDeviceInfo(device, param, size, &value[0], nullptr);
+    value.resize(std::strlen(value.c_str()));
+    return value;
+}
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::vector<OpenCLDeviceInfo> listOpenCLDevices() {
+    std::vector<OpenCLDeviceInfo> devices;
+    cl_uint numPlatforms = 0;
+    if (clGetPlatformIDs(0, nullptr, &numPlatforms) != CL_SUCCESS || numPlatforms == 0)
+        return devices;
+    std::vector<cl_platform_id> platforms(numPlatforms);
+    if (clGetPlatformIDs(numPlatforms, platforms.data(), nullptr) != CL_SUCCESS)
+        return devices;
+
+    for (cl_platform_id platform : platforms) {
+        cl_uint numDevices = 0;
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 0, nullptr, &numDevices) != CL_SUCCESS || numDevices == 0)
+            continue;
+        std::vector<cl_device_id> ids(numDevices);
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, numDevices, ids.data(), nullptr) != CL_SUCCESS)
+            continue;
+
+        std::string platformName = platformString(platform, CL_PLATFORM_NAME);
+        for (cl_device_id id : ids) {
+            OpenCLDeviceInfo info;
+            info.index = devices.size();
+            info.platform = platform;
+            info.id = id;
+            info.platformName = platformName;
+            info.name = openclDeviceString(id, CL_DEVICE_NAME);
+            info.type = 0;
+            info.computeUnits = 0;
+            info.localMemory = 0;
+            info.maxWorkGroupSize = 0;
+            clGetDeviceInfo(id, CL_DEVICE_TYPE, sizeof(info.type), &info.type, nullptr);
+            clGetDeviceInfo(id, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(info.computeUnits), &info.computeUnits, nullptr);
+            clGetDeviceInfo(id, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(info.localMemory), &info.localMemory, nullptr);
+            clGetDeviceInfo(id, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(info.maxWorkGroupSize), &info.maxWorkGroupSize, nullptr);
+            devices.push_back(info);
+        }
+    }
+    return devices;
+}
+
+const char* openclDeviceTypeName(cl_device_type type) {
+    if (type & CL_DEVICE_TYPE_GPU)
+        return "GPU";
+    if (type & CL_DEVICE_TYPE_CPU)
+        return "CPU";
+    if (type & CL_DEVICE_TYPE_ACCELERATOR)
+        return "accelerator";
+    return "other";
+}
+
+bool findOpenCLDevice(const std::vector<OpenCLDeviceInfo>& devices, const std::string& selector, size_t& index) {
+    if (devices.empty())
+        return false;
+
+    if (selector.empty()) {
+        for (const OpenCLDeviceInfo& info : devices) {
+            if (info.type & CL_DEVICE_TYPE_GPU) {
+                index = info.index;
+                return true;
+            }
+        }
+        index = 0;
+        return true;
+    }
+
+    if (selector.size() <= 9
+        && std::all_of(selector.begin(), selector.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        size_t requested = std::stoul(selector);
+        if (requested >= devices.size())
+            return false;
+        index = requested;
+        return true;
+    }
+
+    std::string needle = toLower(selector);
+    for (const OpenCLDeviceInfo& info : devices) {
+        if (toLower(info.name).find(needle) != std::string::npos
+            || toLower(info.platformName).find(needle) != std::string::npos) {
+            index = info.index;
+            return true;
+        }
+    }
+    return false;
+}
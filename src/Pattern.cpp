@@ -0,0 +1,294 @@
+#include "../include/Pattern.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <bitset>
+
+Pattern::Pattern()
+    : m_width(0), m_height(0), m_wordsPerRow(0)
+{
+}
+
+Pattern::Pattern(size_t width, size_t height)
+    : m_width(width), m_height(height), m_wordsPerRow((width + 63) / 64),
+      m_words(m_wordsPerRow * height, 0)
+{
+}
+
+static std::string trim(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin])))
+        ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1])))
+        --end;
+    return text.substr(begin, end - begin);
+}
+
+static size_t parseSize(const std::string& text, const char* what) {
+    try {
+        size_t consumed = 0;
+        unsigned long long value = std::stoull(text, &consumed);
+        if (consumed != text.size())
+            throw std::invalid_argument(text);
+        return static_cast<size_t>(value);
+    } catch (const std::logic_error&) {
+        throw std::runtime_error(std::string("Invalid ") + what + " in pattern: '" + text + "'");
+    }
+}
+
+// Largest bounding box either parser allocates, in cells (512 MiB of bits)
+static const unsigned long long maxPatternCells = 1ULL << 32;
+
+static void checkPatternSize(unsigned long long width, unsigned long long height) {
+    if (width > maxPatternCells || height > maxPatternCells ||
+        (width != 0 && height > maxPatternCells / width))
+        throw std::runtime_error("Pattern bounding box of " + std::to_string(width) + " x " +
+                                 std::to_string(height) + " cells exceeds the limit of " +
+                                 std::to_string(maxPatternCells) + " cells.");
+}
+
+namespace {
+struct LiveRun {
+    size_t x, y, length;
+};
+}
+
+Pattern Pattern::parseRLE(const std::string& text) {
+    std::istringstream lines(text);
+    std::string line;
+    std::string name;
+    std::string rule;
+    size_t headerWidth = 0;
+    size_t headerHeight = 0;
+    bool headerSeen = false;
+
+    std::vector<LiveRun> runs;
+    size_t x = 0;
+    size_t y = 0;
+    size_t count = 0;
+    size_t width = 0;
+    bool finished = false;
+
+    while (!finished && std::getline(lines, line)) {
+        std::string trimmed = trim(line);
+        if (trimmed.empty())
+            continue;
+        if (trimmed[0] == '#') {
+            if (trimmed.size() > 1 && trimmed[1] == 'N')
+                name = trim(trimmed.substr(2));
+            else if (trimmed.size() > 1 && trimmed[1] == 'r')
+                rule = trim(trimmed.substr(2));
+            continue;
+        }
+
+        // "x = m, y = n[, rule = B3/S23]" precedes the cell data
+        if (!headerSeen && trimmed[0] == 'x') {
+            std::istringstream fields(trimmed);
+            std::string field;
+            while (std::getline(fields, field, ',')) {
+                size_t equals = field.find('=');
+                if (equals == std::string::npos)
+                    throw std::runtime_error("Malformed RLE header: '" + trimmed + "'");
+                std::string key = trim(field.substr(0, equals));
+                std::string value = trim(field.substr(equals + 1));
+                if (key == "x")
+                    headerWidth = parseSize(value, "width");
+                else if (key == "y")
+                    headerHeight = parseSize(value, "height");
+                else if (key == "rule")
+                    rule = value;
+            }
+            headerSeen = true;
+            continue;
+        }
+
+        for (char c : trimmed) {
+            if (std::isdigit(static_cast<unsigned char>(c))) {
+                if (count > (SIZE_MAX - 9) / 10)
+                    throw std::runtime_error("Run count too large in RLE pattern.");
+                count = count * 10 + static_cast<size_t>(c - '0');
+                continue;
+            }
+            if (std::isspace(static_cast<unsigned char>(c)))
+                continue;
+
+            size_t length = count ? count : 1;
+            count = 0;
+            if (c == 'b' || c == '.') {
+                x += length;
+            } else if (c == '$') {
+                y += length;
+                x = 0;
+            } else if (c == '!') {
+                finished = true;
+                break;
+            } else if (std::isalpha(static_cast<unsigned char>(c))) {
+                // 'o' in two-state patterns; any other state letter is alive too
+                runs.push_back(LiveRun{ x, y, length });
+                x += length;
+                width = std::max(width, x);
+            } else {
+                throw std::runtime_error(std::string("Unexpected character '") + c + "' in RLE pattern.");
+            }
+        }
+    }
+
+    size_t height = runs.empty() ? 0 : runs.back().y + 1;
+    checkPatternSize(std::max(width, headerWidth), std::max(height, headerHeight));
+    Pattern pattern(std::max(width, headerWidth), std::max(height, headerHeight));
+    for (const LiveRun& run : runs)
+        pattern.setRun(run.x, run.y, run.length);
+    pattern.m_name = name;
+    pattern.m_rule = rule;
+    return pattern;
+}
+
+Pattern Pattern::parseLife106(const std::string& text) {
+    std::istringstream lines(text);
+    std::string line;
+    std::vector<std::pair<long long, long long>> cells;
+    long long minX = LLONG_MAX, minY = LLONG_MAX;
+    long long maxX = LLONG_MIN, maxY = LLONG_MIN;
+
+    while (std::getline(lines, line)) {
+        std::string trimmed = trim(line);
+        if (trimmed.empty() || trimmed[0] == '#')
+            continue;
+        std::istringstream coordinates(trimmed);
+        long long cx = 0, cy = 0;
+        if (!(coordinates >> cx >> cy))
+            throw std::runtime_error("Malformed Life 1.06 line: '" + trimmed + "'");
+        cells.emplace_back(cx, cy);
+        minX = std::min(minX, cx);
+        minY = std::min(minY, cy);
+        maxX = std::max(maxX, cx);
+        maxY = std::max(maxY, cy);
+    }
+
+    if (cells.empty())
+        return Pattern();
+
+    // Coordinates are relative to an arbitrary origin; anchor the bounding box at (0, 0).
+    // The spans are taken unsigned so that far-apart coordinates cannot overflow.
+    unsigned long long spanX = static_cast<unsigned long long>(maxX) - static_cast<unsigned long long>(minX);
+    unsigned long long spanY = static_cast<unsigned long long>(maxY) - static_cast<unsigned long long>(minY);
+    checkPatternSize(std::min(spanX, maxPatternCells) + 1, std::min(spanY, maxPatternCells) + 1);
+    Pattern pattern(static_cast<size_t>(spanX + 1), static_cast<size_t>(spanY + 1));
+    for (const auto& cell : cells)
+        pattern.setCell(static_cast<size_t>(cell.first - minX), static_cast<size_t>(cell.second - minY));
+    return pattern;
+}
+
+Pattern Pattern::parse(const std::string& text) {
+    if (text.compare(0, 10, "#Life 1.06") == 0)
+        return parseLife106(text);
+    return parseRLE(text);
+}
+
+Pattern Pattern::loadFile(const std::string& filename) {
+    std::ifstream infile(filename, std::ios::binary);
+    if (!infile.is_open())
+        throw std::runtime_error("Failed to open pattern file: " + filename);
+    std::ostringstream contents;
+    contents << infile.rdbuf();
+
+    Pattern pattern = parse(contents.str());
+    if (pattern.m_name.empty())
+        pattern.m_name = filename;
+    return pattern;
+}
+
+void Pattern::setCell(size_t x, size_t y) {
+    if (x < m_width && y < m_height)
+        m_words[y * m_wordsPerRow + x / 64] |= uint64_t(1) << (x % 64);
+}
+
+void Pattern::setRun(size_t x, size_t y, size_t length) {
+    if (y >= m_height || x >= m_width)
+        return;
+    size_t end = std::min(x + length, m_width);
+    uint64_t* words = m_words.data() + y * m_wordsPerRow;
+    while (x < end) {
+        size_t bit = x % 64;
+        size_t span = std::min<size_t>(64 - bit, end - x);
+        uint64_t mask = (span == 64) ? ~uint64_t(0) : ((uint64_t(1) << span) - 1) << bit;
+        words[x / 64] |= mask;
+        x += span;
+    }
+}
+
+bool Pattern::getCell(size_t x, size_t y) const {
+    if (x >= m_width || y >= m_height)
+        return false;
+    return (m_words[y * m_wordsPerRow + x / 64] >> (x % 64)) & 1;
+}
+
+size_t Pattern::population() const {
+    size_t count = 0;
+    for (uint64_t word : m_words)
+        count += std::bitset<64>(word).count();
+    return count;
+}
+
+size_t Pattern::getWidth() const {
+    return m_width;
+}
+
+size_t Pattern::getHeight() const {
+    return m_height;
+}
+
+size_t Pattern::getWordsPerRow() const {
+    return m_wordsPerRow;
+}
+
+const uint64_t* Pattern::row(size_t y) const {
+    return m_words.data() + y * m_wordsPerRow;
+}
+
+void Pattern::setName(const std::string& name) {
+    m_name = name;
+}
+
+const std::string& Pattern::getName() const {
+    return m_name;
+}
+
+const std::string& Pattern::getRule() const {
+    return m_rule;
+}
+
+PatternLibrary::PatternLibrary() {
+    static const char* const builtins[][2] = {
+        { "glider",     "x = 3, y = 3\nbo$2bo$3o!" },
+        { "toad",       "x = 4, y = 2\nb3o$3o!" },
+        { "beacon",     "x = 4, y = 4\n2o$2o$2b2o$2b2o!" },
+        { "methuselah", "x = 3, y = 3\nbo$obo$2o!" },
+        { "rpentomino", "x = 3, y = 3\nb2o$2o$bo!" },
+        { "acorn",      "x = 7, y = 3\nbo$3bo$2o2b3o!" },
+        { "gosper",     "x = 36, y = 9\n"
+                        "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$"
+                        "2o8bo3bob2o4bobo$10bo5bo7bo$11bo3bo$12b2o!" }
+    };
+    for (const auto& builtin : builtins) {
+        Pattern pattern = Pattern::parseRLE(builtin[1]);
+        pattern.setName(builtin[0]);
+        m_patterns.emplace(builtin[0], pattern);
+        m_builtinNames.push_back(builtin[0]);
+    }
+}
+
+const Pattern& PatternLibrary::get(const std::string& nameOrPath) {
+    auto it = m_patterns.find(nameOrPath);
+    if (it != m_patterns.end())
+        return it->second;
+    return m_patterns.emplace(nameOrPath, Pattern::loadFile(nameOrPath)).first->second;
+}
+
+const std::vector<std::string>& PatternLibrary::getBuiltinNames() const {
+    return m_builtinNames;
+}
@@ -0,0 +1,146 @@
+#include "../include/ProgramCache.h"
+#include "../include/WorldFile.h"
+#include "../include/OpenCLDevice.h"
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+static const char programCacheMagic[4] = { 'G', 'O', 'L', 'K' };
+static const uint32_t programCacheVersion = 1;
+
+// Entry layout: magic, version, description length, description, binary
+// size, CRC-32 of the binary, binary. Integers are little-endian.
+static void writeLE(std::ofstream& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i)
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static bool readLE(std::ifstream& in, uint64_t& value, int bytes) {
+    unsigned char buffer[8];
+    if (!in.read(reinterpret_cast<char*>(buffer), bytes))
+        return false;
+    value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+    return true;
+}
+
+// FNV-1a, only used to name entries; the full description is compared on load
+static uint64_t hashBytes(uint64_t hash, const std::string& bytes) {
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string& directoryOverride() {
+    static std::string directory;
+    return directory;
+}
+
+void setProgramCacheDirectory(const std::string& directory) {
+    directoryOverride() = directory;
+}
+
+static std::string cacheDirectory() {
+    if (!directoryOverride().empty())
+        return directoryOverride();
+    const char* dir = std::getenv("GOL_KERNEL_CACHE_DIR");
+    if (!dir || !*dir)
+        return "gol_kernel_cache";
+    return dir;
+}
+
+ProgramCacheKey makeProgramCacheKey(cl_device_id device, const std::string& source, const std::string& options) {
+    const uint64_t fnvOffset = 14695981039346656037ull;
+    char sourceHash[17];
+    std::snprintf(sourceHash, sizeof(sourceHash), "%016llx",
+                  static_cast<unsigned long long>(hashBytes(hashBytes(fnvOffset, source), options)));
+
+    ProgramCacheKey key;
+    key.description = openclDeviceString(device, CL_DEVICE_NAME) + "|" + openclDeviceString(device, CL_DRIVER_VERSION)
+                    + "|" + openclDeviceString(device, CL_DEVICE_VERSION) + "|" + sourceHash;
+
+    std::string dir = cacheDirectory();
+    if (dir == "off")
+        return key;
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin",
+                  static_cast<unsigned long long>(hashBytes(fnvOffset, key.description)));
+    key.filename = (std::filesystem::path(dir) / name).string();
+    return key;
+}
+
+bool loadProgramBinary(const ProgramCacheKey& key, std::vector<unsigned char>& binary) {
+    if (key.filename.empty())
+        return false;
+    std::ifstream in(key.filename, std::ios::binary);
+    if (!in)
+        return false;
+
+    char magic[4];
+    uint64_t version = 0, descriptionSize = 0, binarySize = 0, checksum = 0;
+    if (!in.read(magic, 4) || std::memcmp(magic, programCacheMagic, 4) != 0
+        || !readLE(in, version, 4) || version != programCacheVersion
+        || !readLE(in, descriptionSize, 4) || descriptionSize != key.description.size())
+        return false;
+    std::string description(key.description.size(), '\0');
+    if (!in.read(&description[0], description.size()) || description != key.description)
+        return false;
+    if (!readLE(in, binarySize, 8) || !readLE(in, checksum, 4) || binarySize == 0 || binarySize > (uint64_t(1) << 30))
+        return false;
+
+    binary.resize(static_cast<size_t>(binarySize));
+    if (!in.read(reinterpret_cast<char*>(binary.data()), binary.size()))
+        return false;
+    return worldFileCrc32(0, binary.data(), binary.size()) == checksum;
+}
+
+void storeProgramBinary(const ProgramCacheKey& key, cl_program program) {
+    if (key.filename.empty())
+        return;
+
+    size_t binarySize = 0;
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &binarySize, nullptr) != CL_SUCCESS
+        || binarySize == 0)
+        return;
+    std::vector<unsigned char> binary(binarySize);
+    unsigned char* binaries[1] = { binary.data() };
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaries), binaries, nullptr) != CL_SUCCESS)
+        return;
+
+    std::error_code error;
+    std::filesystem::path path(key.filename);
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error)
+        return;
+
+    // Written under a temporary name so concurrent processes never load a
+    // partial entry
+    std::string tempName = key.filename + ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream out(tempName, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+        out.write(programCacheMagic, 4);
+        writeLE(out, programCacheVersion, 4);
+        writeLE(out, key.description.size(), 4);
+        out.write(key.description.data(), key.description.size());
+        writeLE(out, binary.size(), 8);
+        writeLE(out, worldFileCrc32(0, binary.data(), binary.size()), 4);
+        out.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+        if (!out) {
+            out.close();
+            std::remove(tempName.c_str());
+            return;
+        }
+    }
+    std::filesystem::rename(tempName, path, error);
+    if (error)
+        std::remove(tempName.c_str());
+}
@@ -0,0 +1,280 @@
+#include "../include/Rule.h"
+#include <stdexcept>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+
+static const int maxStates = 256;   // dying states must fit the uchar OpenCL storage
+static const int maxRange = 500;
+
+bool Rule::isConway() const {
+    return !isLargerThanLife() && states == 2 && birth == (1u << 3) && survival == ((1u << 2) | (1u << 3));
+}
+
+bool Rule::isLifeLike() const {
+    return !isLargerThanLife() && states == 2;
+}
+
+bool Rule::isLargerThanLife() const {
+    return range > 1 || vonNeumann;
+}
+
+bool Rule::born(int count) const {
+    if (isLargerThanLife())
+        return count >= birthMin && count <= birthMax;
+    return count >= 0 && count <= 8 && ((birth >> count) & 1u);
+}
+
+bool Rule::survives(int count) const {
+    if (isLargerThanLife())
+        return count >= survivalMin && count <= survivalMax;
+    return count >= 0 && count <= 8 && ((survival >> count) & 1u);
+}
+
+bool Rule::operator==(const Rule& other) const {
+    return ruleToString(*this) == ruleToString(other);
+}
+
+bool Rule::operator!=(const Rule& other) const {
+    return !(*this == other);
+}
+
+static std::string lowercase(const std::string& text) {
+    std::string result;
+    for (char c : text)
+        if (!std::isspace(static_cast<unsigned char>(c)))
+            result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return result;
+}
+
+static std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find(separator, start);
+        parts.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos)
+            return parts;
+        start = end + 1;
+    }
+}
+
+// Digits 0-8 as a neighbour-count mask
+static uint32_t parseCounts(const std::string& digits, const std::string& rule) {
+    uint32_t mask = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '8')
+            throw std::invalid_argument("Invalid neighbour count in rule '" + rule + "'.");
+        mask |= 1u << (c - '0');
+    }
+    return mask;
+}
+
+static int parseNumber(const std::string& digits, const std::string& rule) {
+    if (digits.empty() || digits.size() > 6)
+        throw std::invalid_argument("Invalid number in rule '" + rule + "'.");
+    for (char c : digits)
+        if (!std::isdigit(static_cast<unsigned char>(c)))
+            throw std::invalid_argument("Invalid number in rule '" + rule + "'.");
+    return std::atoi(digits.c_str());
+}
+
+static void parseStates(Rule& rule, const std::string& digits, const std::string& text) {
+    int states = parseNumber(digits, text);
+    rule.states = (states < 2) ? 2 : states;
+    if (rule.states > maxStates)
+        throw std::invalid_argument("Rules are limited to " + std::to_string(maxStates) + " states.");
+}
+
+static void parseInterval(const std::string& text, int& low, int& high, const std::string& rule) {
+    size_t dots = text.find("..");
+    if (dots == std::string::npos) {
+        low = high = parseNumber(text, rule);
+        return;
+    }
+    low = parseNumber(text.substr(0, dots), rule);
+    high = parseNumber(text.substr(dots + 2), rule);
+}
+
+// Golly's Larger than Life notation, e.g. "R5,C0,M1,S34..58,B34..45,NM"
+static Rule parseLargerThanLife(const std::string& text, const std::string& original) {
+    Rule rule;
+    bool hasBirth = false, hasSurvival = false;
+    for (const std::string& part : split(text, ',')) {
+        if (part.empty())
+            throw std::invalid_argument("Invalid rule '" + original + "'.");
+        std::string value = part.substr(1);
+        switch (part[0]) {
+        case 'r': rule.range = parseNumber(value, original); break;
+        case 'c': parseStates(rule, value, original); break;
+        case 'm': rule.countCenter = parseNumber(value, original) != 0; break;
+        case 's': parseInterval(value, rule.survivalMin, rule.survivalMax, original); hasSurvival = true; break;
+        case 'b': parseInterval(value, rule.birthMin, rule.birthMax, original); hasBirth = true; break;
+        case 'n':
+            if (value != "m" && value != "n")
+                throw std::invalid_argument("Unknown neighbourhood in rule '" + original + "'.");
+            rule.vonNeumann = (value == "n");
+            break;
+        default:
+            throw std::invalid_argument("Invalid rule '" + original + "'.");
+        }
+    }
+    if (!hasBirth || !hasSurvival || rule.range < 1 || rule.range > maxRange)
+        throw std::invalid_argument("Invalid rule '" + original + "'.");
+
+    // Range 1 with the square neighbourhood is an ordinary mask rule, which
+    // runs on the faster kernels; a counted centre shifts survival by one
+    if (rule.range == 1 && !rule.vonNeumann) {
+        rule.birth = rule.survival = 0;
+        for (int n = 0; n <= 8; ++n) {
+            if (n >= rule.birthMin && n <= rule.birthMax)
+                rule.birth |= 1u << n;
+            int counted = rule.countCenter ? n + 1 : n;
+            if (counted >= rule.survivalMin && counted <= rule.survivalMax)
+                rule.survival |= 1u << n;
+        }
+        rule.countCenter = false;
+        rule.birthMin = rule.survivalMin = 0;
+        rule.birthMax = rule.survivalMax = -1;
+    }
+    return rule;
+}
+
+Rule parseRule(const std::string& original) {
+    std::string text = lowercase(original);
+
+    static const char* const names[][2] = {
+        { "life", "B3/S23" },
+        { "conway", "B3/S23" },
+        { "highlife", "B36/S23" },
+        { "daynight", "B3678/S34678" },
+        { "day&night", "B3678/S34678" },
+        { "seeds", "B2/S" },
+        { "lifewithoutdeath", "B3/S012345678" },
+        { "replicator", "B1357/S1357" },
+        { "maze", "B3/S12345" },
+        { "briansbrain", "B2/S/C3" },
+        { "starwars", "B2/S345/C4" },
+        { "bugs", "R5,C0,M1,S34..58,B34..45,NM" },
+    };
+    for (const auto& name : names)
+        if (text == name[0])
+            return parseRule(name[1]);
+
+    if (text.size() > 1 && text[0] == 'r' && std::isdigit(static_cast<unsigned char>(text[1])))
+        return parseLargerThanLife(text, original);
+
+    std::vector<std::string> parts = split(text, '/');
+    if (parts.size() < 2 || parts.size() > 3)
+        throw std::invalid_argument("Invalid rule '" + original + "'.");
+
+    Rule rule;
+    bool prefixed = false;
+    for (const std::string& part : parts)
+        if (!part.empty() && (part[0] == 'b' || part[0] == 's' || part[0] == 'c'))
+            prefixed = true;
+
+    if (prefixed) {
+        // B/S/C parts in any order; an unprefixed third part is the state count
+        bool hasBirth = false, hasSurvival = false;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            const std::string& part = parts[i];
+            if (!part.empty() && part[0] == 'b') {
+                rule.birth = parseCounts(part.substr(1), original);
+                hasBirth = true;
+            } else if (!part.empty() && part[0] == 's') {
+                rule.survival = parseCounts(part.substr(1), original);
+                hasSurvival = true;
+            } else if (!part.empty() && part[0] == 'c') {
+                parseStates(rule, part.substr(1), original);
+            } else if (i == 2) {
+                parseStates(rule, part, original);
+            } else {
+                throw std::invalid_argument("Invalid rule '" + original + "'.");
+            }
+        }
+        if (!hasBirth || !hasSurvival)
+            throw std::invalid_argument("Rule '" + original + "' needs both B and S parts.");
+    } else {
+        // Older S/B and S/B/C notation
+        rule.survival = parseCounts(parts[0], original);
+        rule.birth = parseCounts(parts[1], original);
+        if (parts.size() == 3)
+            parseStates(rule, parts[2], original);
+    }
+    return rule;
+}
+
+static std::string countDigits(uint32_t mask) {
+    std::string digits;
+    for (int n = 0; n <= 8; ++n)
+        if ((mask >> n) & 1u)
+            digits += static_cast<char>('0' + n);
+    return digits;
+}
+
+std::string ruleToString(const Rule& rule) {
+    if (rule.isLargerThanLife()) {
+        return "R" + std::to_string(rule.range) + ",C" + std::to_string(rule.states == 2 ? 0 : rule.states)
+             + ",M" + (rule.countCenter ? "1" : "0")
+             + ",S" + std::to_string(rule.survivalMin) + ".." + std::to_string(rule.survivalMax)
+             + ",B" + std::to_string(rule.birthMin) + ".." + std::to_string(rule.birthMax)
+             + ",N" + (rule.vonNeumann ? "N" : "M");
+    }
+    std::string text = "B" + countDigits(rule.birth) + "/S" + countDigits(rule.survival);
+    if (rule.states > 2)
+        text += "/C" + std::to_string(rule.states);
+    return text;
+}
+
+std::string ruleBuildOptions(const Rule& rule) {
+    std::string options = "-DRULE_BIRTH=" + std::to_string(rule.birth)
+                        + " -DRULE_SURVIVAL=" + std::to_string(rule.survival)
+                        + " -DRULE_STATES=" + std::to_string(rule.states);
+    if (rule.isLargerThanLife()) {
+        options += " -DRULE_RANGE=" + std::to_string(rule.range)
+                 + " -DRULE_VON_NEUMANN=" + (rule.vonNeumann ? "1" : "0")
+                 + " -DRULE_COUNT_CENTER=" + (rule.countCenter ? "1" : "0")
+                 + " -DRULE_BIRTH_MIN=" + std::to_string(rule.birthMin)
+                 + " -DRULE_BIRTH_MAX=" + std::to_string(rule.birthMax)
+                 + " -DRULE_SURVIVAL_MIN=" + std::to_string(rule.survivalMin)
+                 + " -DRULE_SURVIVAL_MAX=" + std::to_string(rule.survivalMax);
+    }
+    return options;
+}
+
+const char* ruleKernelMacros() {
+    return R"CLC(
+// Next-state function of the rule given by the RULE_* build options. The
+// masks are compile-time constants, so no rule is looked up per cell.
+#ifndef RULE_STATES
+#define RULE_BIRTH 8
+#define RULE_SURVIVAL 12
+#define RULE_STATES 2
+#endif
+
+// Only live cells count as neighbours; dying states are 2 and up
+#if RULE_STATES > 2
+#define ALIVE(v) ((v) == 1)
+#else
+#define ALIVE(v) (v)
+#endif
+
+#ifdef RULE_RANGE
+#define BORN(n) ((n) >= RULE_BIRTH_MIN && (n) <= RULE_BIRTH_MAX)
+#define SURVIVES(n) ((n) >= RULE_SURVIVAL_MIN && (n) <= RULE_SURVIVAL_MAX)
+#else
+#define BORN(n) ((RULE_BIRTH >> (n)) & 1)
+#define SURVIVES(n) ((RULE_SURVIVAL >> (n)) & 1)
+#endif
+
+#if RULE_STATES > 2
+#define NEXT_STATE(s, n) ((s) == 0 ? BORN(n) : (s) == 1 ? (SURVIVES(n) ? 1 : 2) : ((s) + 1) % RULE_STATES)
+#elif !defined(RULE_RANGE) && RULE_BIRTH == 8 && RULE_SURVIVAL == 12
+#define RULE_CONWAY 1
+#define NEXT_STATE(s, n) ((s) == 1 ? (((n) == 2) || ((n) == 3)) : ((n) == 3))
+#else
+#define NEXT_STATE(s, n) ((s) ? SURVIVES(n) : BORN(n))
+#endif
+)CLC";
+}
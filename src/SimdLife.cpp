@@ -0,0 +1,245 @@
+#include "../include/SimdLife.h"
+#include <stdexcept>
+#include <cstring>
+
+// The vector paths are compiled with per-function target attributes, so
+// the binary runs on any CPU of its architecture and bestIsa() picks the
+// widest path the running CPU supports.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMDLIFE_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__)
+#define SIMDLIFE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Row evolution with the column sums of a row at sums[x + 1]; sums[0] and
+// sums[width + 1] hold the wrapped columns
+// Offset of the live-cell table in SimdLife::m_tables
+static const size_t aliveTable = 64;
+
+typedef void (*RowFunction)(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* out,
+                            uint8_t* sums, size_t width, const uint8_t* tables);
+
+static inline void columnSums(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* sums,
+                              size_t begin, size_t end)
+{
+    for (size_t x = begin; x < end; ++x)
+        sums[x + 1] = static_cast<uint8_t>(up[x] + mid[x] + down[x]);
+}
+
+static inline void wrapColumns(uint8_t* sums, size_t width) {
+    sums[0] = sums[width];
+    sums[width + 1] = sums[1];
+}
+
+static inline void applyRule(const uint8_t* mid, const uint8_t* sums, uint8_t* out, const uint8_t* tables,
+                             size_t begin, size_t end)
+{
+    for (size_t x = begin; x < end; ++x) {
+        unsigned box = sums[x] + sums[x + 1] + sums[x + 2];
+        out[x] = tables[(mid[x] ? aliveTable : 0) + box];
+    }
+}
+
+static void evolveRowScalar(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* out,
+                            uint8_t* sums, size_t width, const uint8_t* tables)
+{
+    columnSums(up, mid, down, sums, 0, width);
+    wrapColumns(sums, width);
+    applyRule(mid, sums, out, tables, 0, width);
+}
+
+#ifdef SIMDLIFE_X86
+__attribute__((target("avx2")))
+static void evolveRowAvx2(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* out,
+                          uint8_t* sums, size_t width, const uint8_t* tables)
+{
+    size_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i sum = _mm256_add_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + x)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mid + x)));
+        sum = _mm256_add_epi8(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + x)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + x + 1), sum);
+    }
+    columnSums(up, mid, down, sums, x, width);
+    wrapColumns(sums, width);
+
+    // The shuffles look up 16-byte tables within each 128-bit lane
+    const __m256i dead = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tables));
+    const __m256i alive = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tables + aliveTable));
+    const __m256i zero = _mm256_setzero_si256();
+    for (x = 0; x + 32 <= width; x += 32) {
+        __m256i box = _mm256_add_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + x)),
+                                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + x + 1)));
+        box = _mm256_add_epi8(box, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + x + 2)));
+        __m256i isAlive = _mm256_cmpgt_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(mid + x)), zero);
+        __m256i next = _mm256_blendv_epi8(_mm256_shuffle_epi8(dead, box), _mm256_shuffle_epi8(alive, box), isAlive);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), next);
+    }
+    applyRule(mid, sums, out, tables, x, width);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void evolveRowAvx512(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* out,
+                            uint8_t* sums, size_t width, const uint8_t* tables)
+{
+    size_t x = 0;
+    for (; x + 64 <= width; x += 64) {
+        __m512i sum = _mm512_add_epi8(_mm512_loadu_si512(up + x), _mm512_loadu_si512(mid + x));
+        sum = _mm512_add_epi8(sum, _mm512_loadu_si512(down + x));
+        _mm512_storeu_si512(sums + x + 1, sum);
+    }
+    columnSums(up, mid, down, sums, x, width);
+    wrapColumns(sums, width);
+
+    const __m512i dead = _mm512_loadu_si512(tables);
+    const __m512i alive = _mm512_loadu_si512(tables + aliveTable);
+    for (x = 0; x + 64 <= width; x += 64) {
+        __m512i box = _mm512_add_epi8(_mm512_loadu_si512(sums + x), _mm512_loadu_si512(sums + x + 1));
+        box = _mm512_add_epi8(box, _mm512_loadu_si512(sums + x + 2));
+        __m512i cells = _mm512_loadu_si512(mid + x);
+        __mmask64 isAlive = _mm512_test_epi8_mask(cells, cells);
+        __m512i next = _mm512_mask_blend_epi8(isAlive, _mm512_shuffle_epi8(dead, box), _mm512_shuffle_epi8(alive, box));
+        _mm512_storeu_si512(out + x, next);
+    }
+    applyRule(mid, sums, out, tables, x, width);
+}
+#endif
+
+#ifdef SIMDLIFE_NEON
+static void evolveRowNeon(const uint8_t* up, const uint8_t* mid, const uint8_t* down, uint8_t* out,
+                          uint8_t* sums, size_t width, const uint8_t* tables)
+{
+    size_t x = 0;
+    for (; x + 16 <= width; x += 16)
+        vst1q_u8(sums + x + 1, vaddq_u8(vaddq_u8(vld1q_u8(up + x), vld1q_u8(mid + x)), vld1q_u8(down + x)));
+    columnSums(up, mid, down, sums, x, width);
+    wrapColumns(sums, width);
+
+    const uint8x16_t dead = vld1q_u8(tables);
+    const uint8x16_t alive = vld1q_u8(tables + aliveTable);
+    for (x = 0; x + 16 <= width; x += 16) {
+        uint8x16_t box = vaddq_u8(vaddq_u8(vld1q_u8(sums + x), vld1q_u8(sums + x + 1)), vld1q_u8(sums + x + 2));
+        uint8x16_t cells = vld1q_u8(mid + x);
+        vst1q_u8(out + x, vbslq_u8(vtstq_u8(cells, cells), vqtbl1q_u8(alive, box), vqtbl1q_u8(dead, box)));
+    }
+    applyRule(mid, sums, out, tables, x, width);
+}
+#endif
+
+static RowFunction rowFunction(SimdIsa isa) {
+    switch (isa) {
+#ifdef SIMDLIFE_X86
+    case SimdIsa::AVX2: return evolveRowAvx2;
+    case SimdIsa::AVX512: return evolveRowAvx512;
+#endif
+#ifdef SIMDLIFE_NEON
+    case SimdIsa::Neon: return evolveRowNeon;
+#endif
+    default: return evolveRowScalar;
+    }
+}
+
+SimdLife::SimdLife(size_t width, size_t height)
+    : m_width(width), m_height(height), m_isa(bestIsa())
+{
+    if (m_width == 0 || m_height == 0)
+        throw std::invalid_argument("SimdLife dimensions must be > 0.");
+    m_current.resize(m_width * m_height, 0);
+    m_next.resize(m_width * m_height, 0);
+    m_columnSums.resize(m_width + 2, 0);
+    setRule(1u << 3, (1u << 2) | (1u << 3));
+}
+
+void SimdLife::pack(const std::vector<int>& cells) {
+    if (cells.size() != m_width * m_height)
+        throw std::invalid_argument("SimdLife::pack: grid size mismatch.");
+    for (size_t i = 0; i < cells.size(); ++i)
+        m_current[i] = cells[i] != 0 ? 1 : 0;
+}
+
+void SimdLife::unpack(std::vector<int>& cells) const {
+    cells.resize(m_width * m_height);
+    for (size_t i = 0; i < m_current.size(); ++i)
+        cells[i] = m_current[i];
+}
+
+void SimdLife::setRule(uint32_t birth, uint32_t survival) {
+    // A dead cell's box sum is its neighbour count; a live cell counts itself
+    std::memset(m_tables, 0, sizeof(m_tables));
+    for (unsigned n = 0; n <= 8; ++n) {
+        m_tables[n] = static_cast<uint8_t>((birth >> n) & 1u);
+        m_tables[aliveTable + n + 1] = static_cast<uint8_t>((survival >> n) & 1u);
+    }
+    for (size_t copy = 16; copy < aliveTable; copy += 16) {
+        std::memcpy(m_tables + copy, m_tables, 16);
+        std::memcpy(m_tables + aliveTable + copy, m_tables + aliveTable, 16);
+    }
+}
+
+void SimdLife::setIsa(SimdIsa isa) {
+    m_isa = isSupported(isa) ? isa : bestIsa();
+}
+
+SimdIsa SimdLife::getIsa() const {
+    return m_isa;
+}
+
+void SimdLife::evolve(int generations) {
+    RowFunction evolveRow = rowFunction(m_isa);
+    for (int g = 0; g < generations; ++g) {
+        for (size_t y = 0; y < m_height; ++y) {
+            const uint8_t* up = m_current.data() + ((y + m_height - 1) % m_height) * m_width;
+            const uint8_t* mid = m_current.data() + y * m_width;
+            const uint8_t* down = m_current.data() + ((y + 1) % m_height) * m_width;
+            evolveRow(up, mid, down, m_next.data() + y * m_width, m_columnSums.data(), m_width, m_tables);
+        }
+        m_current.swap(m_next);
+    }
+}
+
+bool SimdLife::isSupported(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::Scalar:
+        return true;
+#ifdef SIMDLIFE_X86
+    case SimdIsa::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case SimdIsa::AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+#ifdef SIMDLIFE_NEON
+    case SimdIsa::Neon:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+SimdIsa SimdLife::bestIsa() {
+    for (SimdIsa isa : { SimdIsa::AVX512, SimdIsa::AVX2, SimdIsa::Neon }) {
+        if (isSupported(isa))
+            return isa;
+    }
+    return SimdIsa::Scalar;
+}
+
+const char* SimdLife::isaName(SimdIsa isa) {
+    switch (isa) {
+    case SimdIsa::AVX2: return "avx2";
+    case SimdIsa::AVX512: return "avx512";
+    case SimdIsa::Neon: return "neon";
+    default: return "scalar";
+    }
+}
+
+SimdIsa SimdLife::parseIsa(const std::string& name) {
+    for (SimdIsa isa : { SimdIsa::Scalar, SimdIsa::AVX2, SimdIsa::AVX512, SimdIsa::Neon }) {
+        if (name == isaName(isa))
+            return isa;
+    }
+    throw std::invalid_argument("Unknown instruction set '" + name + "'.");
+}
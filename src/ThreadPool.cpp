@@ -0,0 +1,88 @@
+#include "../include/ThreadPool.h"
+
+Barrier::Barrier(unsigned count)
+    : m_count(count), m_waiting(0), m_phase(0)
+{
+}
+
+void Barrier::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t phase = m_phase;
+    if (++m_waiting == m_count) {
+        m_waiting = 0;
+        ++m_phase;
+        m_condition.notify_all();
+        return;
+    }
+    m_condition.wait(lock, [this, phase] { return m_phase != phase; });
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : m_task(nullptr), m_round(0), m_pending(0), m_stopping(false)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    // The calling thread is worker 0, so only threadCount - 1 are spawned
+    for (unsigned i = 1; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_startCondition.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    uint64_t seenRound = 0;
+    while (true) {
+        const std::function<void(unsigned)>* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, seenRound] {
+                return m_stopping || m_round != seenRound;
+            });
+            if (m_stopping)
+                return;
+            seenRound = m_round;
+            task = m_task;
+        }
+
+        (*task)(index);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0)
+                m_doneCondition.notify_one();
+        }
+    }
+}
+
+void ThreadPool::run(const std::function<void(unsigned)>& task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_pending = static_cast<unsigned>(m_workers.size());
+        ++m_round;
+    }
+    m_startCondition.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] { return m_pending == 0; });
+    m_task = nullptr;
+}
+
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned>(m_workers.size() + 1);
+}
@@ -0,0 +1,409 @@
+#include "../include/WorldBatch.h"
+#include "../include/BitGrid.h"
+#include "../include/OpenCLDevice.h"
+#include "../include/RandomFill.h"
+#include <iostream>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+static const char* batchKernelSource = R"CLC(
+// One work-item per cell of every world; the global size is width x height
+// x worlds and the worlds are stored back to back. changes has three slots
+// of two flags per world, and generation g sets the flags in slot g % 3
+// when a cell differs from the previous generation or from the one before
+// that. Slot (g + 2) % 3 holds the flags of the previous generation and
+// slot (g + 1) % 3 is cleared for the next one, so no flag is read and
+// written in the same launch.
+__kernel void evolveBatch(__global const uchar* current,
+                          __global uchar* next,
+                          __global int* changes,
+                          __global int* settled,
+                          int width,
+                          int height,
+                          int generation)
+{
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+    int world = get_global_id(2);
+    int worlds = get_global_size(2);
+    __global int* written = changes + 2 * worlds * (generation % 3);
+    __global const int* previous = changes + 2 * worlds * ((generation + 2) % 3);
+    __global int* cleared = changes + 2 * worlds * ((generation + 1) % 3);
+
+    // The previous generation repeated the one before it (period 1) or the
+    // one two before it (period 2)
+    int period = 0;
+    if (generation >= 2 && !previous[2 * world])
+        period = 1;
+    else if (generation >= 3 && !previous[2 * world + 1])
+        period = 2;
+
+    if (x == 0 && y == 0) {
+        cleared[2 * world] = 0;
+        cleared[2 * world + 1] = 0;
+        if (period && settled[2 * world] < 0) {
+            settled[2 * world] = generation - 1 - period;
+            settled[2 * world + 1] = period;
+        }
+    }
+    // next still holds the state two generations back, which is exactly
+    // what a settled world would compute
+    if (period)
+        return;
+
+    size_t base = (size_t)world * width * height;
+    __global const uchar* up = current + base + ((y == 0) ? height - 1 : y - 1) * width;
+    __global const uchar* mid = current + base + y * width;
+    __global const uchar* down = current + base + ((y + 1 == height) ? 0 : y + 1) * width;
+    int left = (x == 0) ? width - 1 : x - 1;
+    int right = (x + 1 == width) ? 0 : x + 1;
+    int count = ALIVE(up[left]) + ALIVE(up[x]) + ALIVE(up[right])
+              + ALIVE(mid[left]) + ALIVE(mid[right])
+              + ALIVE(down[left]) + ALIVE(down[x]) + ALIVE(down[right]);
+
+    uchar state = (uchar)NEXT_STATE(mid[x], count);
+    size_t index = base + y * width + x;
+    if (state != mid[x])
+        written[2 * world] = 1;
+    if (state != next[index])
+        written[2 * world + 1] = 1;
+    next[index] = state;
+}
+)CLC";
+
+// Worlds not yet taken by a worker of evolveThreaded()
+struct WorkRange {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+// Takes the next world of the worker's own range; once that is empty, steals
+// the upper half of the first other range that still has worlds
+static bool takeWorld(std::vector<WorkRange>& ranges, unsigned worker, size_t& world) {
+    {
+        std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+        if (ranges[worker].begin < ranges[worker].end) {
+            world = ranges[worker].begin++;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        WorkRange& victim = ranges[(worker + i) % ranges.size()];
+        size_t begin = 0;
+        size_t end = 0;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.begin == victim.end)
+                continue;
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+        world = begin;
+        std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+        ranges[worker].begin = begin + 1;
+        ranges[worker].end = end;
+        return true;
+    }
+    return false;
+}
+
+WorldBatch::WorldBatch(size_t width, size_t height, size_t count, const Rule& rule)
+    : m_width(width), m_height(height), m_count(count), m_rule(rule),
+      m_context(nullptr), m_queue(nullptr), m_program(nullptr), m_kernel(nullptr),
+      m_grids{nullptr, nullptr}, m_changes(nullptr), m_settled(nullptr)
+{
+    if (m_width == 0 || m_height == 0 || m_count == 0)
+        throw std::invalid_argument("WorldBatch dimensions and world count must be > 0.");
+    if (!m_rule.isLifeLike())
+        throw std::invalid_argument("WorldBatch runs two-state rules with the 3x3 neighbourhood only.");
+    m_cells.resize(m_count * m_width * m_height, 0);
+    m_results.resize(m_count);
+}
+
+WorldBatch::~WorldBatch() {
+    cleanupOpenCL();
+}
+
+size_t WorldBatch::getWidth() const {
+    return m_width;
+}
+
+size_t WorldBatch::getHeight() const {
+    return m_height;
+}
+
+size_t WorldBatch::getCount() const {
+    return m_count;
+}
+
+void WorldBatch::setWorld(size_t index, const std::vector<int>& cells) {
+    if (index >= m_count || cells.size() != m_width * m_height)
+        throw std::invalid_argument("WorldBatch::setWorld: bad world index or grid size.");
+    uint8_t* world = m_cells.data() + index * m_width * m_height;
+    for (size_t i = 0; i < cells.size(); ++i)
+        world[i] = cells[i] != 0 ? 1 : 0;
+}
+
+std::vector<int> WorldBatch::getWorld(size_t index) const {
+    if (index >= m_count)
+        throw std::invalid_argument("WorldBatch::getWorld: bad world index.");
+    const uint8_t* world = m_cells.data() + index * m_width * m_height;
+    return std::vector<int>(world, world + m_width * m_height);
+}
+
+void WorldBatch::randomize(double density, uint64_t seed) {
+    // The world index is the Philox stream, so world 0 is the world
+    // GameOfLife::randomize() makes with the same seed
+    const uint64_t threshold = aliveThreshold(density);
+    const size_t cells = m_width * m_height;
+    for (size_t w = 0; w < m_count; ++w)
+        fillRandomCells(m_cells.data() + w * cells, 0, cells, seed, w, threshold);
+}
+
+void WorldBatch::evolveWorld(size_t index, int generations) {
+    uint8_t* cells = m_cells.data() + index * m_width * m_height;
+    BatchWorldResult& result = m_results[index];
+    result = BatchWorldResult();
+
+    BitGrid grid(m_width, m_height);
+    grid.setRule(m_rule.birth, m_rule.survival);
+    for (size_t y = 0; y < m_height; ++y) {
+        for (size_t x = 0; x < m_width; ++x) {
+            if (cells[y * m_width + x])
+                grid.setCellState(x, y, 1);
+        }
+    }
+
+    // The last two generations, to recognise periods 1 and 2
+    std::vector<uint64_t> before1 = grid.getWords();
+    std::vector<uint64_t> before2;
+    const std::vector<uint64_t>* finalWords = &grid.getWords();
+    for (int g = 1; g <= generations; ++g) {
+        grid.evolve(1);
+        const std::vector<uint64_t>& words = grid.getWords();
+        if (words == before1) {
+            result.settledAt = g - 1;
+            result.period = 1;
+            break;
+        }
+        if (g >= 2 && words == before2) {
+            result.settledAt = g - 2;
+            result.period = 2;
+            // The world alternates, so the run ends on whichever of the
+            // two states has the parity of the last generation
+            if ((generations - g) % 2 != 0)
+                finalWords = &before1;
+            break;
+        }
+        before2.swap(before1);
+        before1 = words;
+    }
+
+    const size_t wordsPerRow = grid.getWordsPerRow();
+    size_t population = 0;
+    for (size_t y = 0; y < m_height; ++y) {
+        const uint64_t* row = finalWords->data() + y * wordsPerRow;
+        for (size_t x = 0; x < m_width; ++x) {
+            uint8_t state = static_cast<uint8_t>((row[x / 64] >> (x % 64)) & 1u);
+            cells[y * m_width + x] = state;
+            population += state;
+        }
+    }
+    result.population = population;
+}
+
+void WorldBatch::evolveThreaded(int generations, unsigned threadCount) {
+    if (!m_threadPool || (threadCount != 0 && m_threadPool->size() != threadCount))
+        m_threadPool.reset(new ThreadPool(threadCount));
+
+    // Each worker starts on an equal share of the worlds; settled worlds
+    // finish early, so workers that run dry steal from the others
+    const unsigned workers = m_threadPool->size();
+    std::vector<WorkRange> ranges(workers);
+    for (unsigned w = 0; w < workers; ++w) {
+        ranges[w].begin = m_count * w / workers;
+        ranges[w].end = m_count * (w + 1) / workers;
+    }
+    m_threadPool->run([&](unsigned worker) {
+        size_t world = 0;
+        while (takeWorld(ranges, worker, world))
+            evolveWorld(world, std::max(0, generations));
+    });
+}
+
+bool WorldBatch::initializeOpenCL(const std::string& device) {
+    if (m_context)
+        return true;
+
+    std::vector<OpenCLDeviceInfo> available = listOpenCLDevices();
+    size_t index = 0;
+    if (!findOpenCLDevice(available, device, index)) {
+        std::cerr << "No OpenCL device matches '" << device << "'." << std::endl;
+        return false;
+    }
+    cl_device_id id = available[index].id;
+    m_deviceName = available[index].name;
+
+    cl_int err = CL_SUCCESS;
+    m_context = clCreateContext(nullptr, 1, &id, nullptr, nullptr, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create OpenCL context." << std::endl;
+        m_context = nullptr;
+        return false;
+    }
+    m_queue = clCreateCommandQueue(m_context, id, 0, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create command queue." << std::endl;
+        m_queue = nullptr;
+        cleanupOpenCL();
+        return false;
+    }
+
+    std::string kernelSource = std::string(ruleKernelMacros()) + batchKernelSource;
+    std::string buildOptions = ruleBuildOptions(m_rule);
+    const char* source = kernelSource.c_str();
+    size_t sourceSize = kernelSource.size();
+    m_program = clCreateProgramWithSource(m_context, 1, &source, &sourceSize, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create program." << std::endl;
+        m_program = nullptr;
+        cleanupOpenCL();
+        return false;
+    }
+    err = clBuildProgram(m_program, 1, &id, buildOptions.c_str(), nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        size_t logSize;
+        clGetProgramBuildInfo(m_program, id, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logSize);
+        std::string buildLog(logSize, ' ');
+        clGetProgramBuildInfo(m_program, id, CL_PROGRAM_BUILD_LOG, logSize, &buildLog[0], nullptr);
+        std::cerr << "Build error:\n" << buildLog << std::endl;
+        cleanupOpenCL();
+        return false;
+    }
+    m_kernel = clCreateKernel(m_program, "evolveBatch", &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create kernel." << std::endl;
+        m_kernel = nullptr;
+        cleanupOpenCL();
+        return false;
+    }
+
+    for (int i = 0; i < 2 && err == CL_SUCCESS; ++i)
+        m_grids[i] = clCreateBuffer(m_context, CL_MEM_READ_WRITE, m_cells.size(), nullptr, &err);
+    if (err == CL_SUCCESS)
+        m_changes = clCreateBuffer(m_context, CL_MEM_READ_WRITE, sizeof(cl_int) * 6 * m_count, nullptr, &err);
+    if (err == CL_SUCCESS)
+        m_settled = clCreateBuffer(m_context, CL_MEM_READ_WRITE, sizeof(cl_int) * 2 * m_count, nullptr, &err);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to create batch buffers." << std::endl;
+        cleanupOpenCL();
+        return false;
+    }
+    return true;
+}
+
+bool WorldBatch::evolveOpenCL(int generations) {
+    if (!initializeOpenCL())
+        return false;
+
+    std::vector<cl_int> changes(6 * m_count, 0);
+    std::vector<cl_int> settled(2 * m_count, -1);
+    cl_int err = clEnqueueWriteBuffer(m_queue, m_grids[0], CL_FALSE, 0, m_cells.size(), m_cells.data(),
+                                      0, nullptr, nullptr);
+    err |= clEnqueueWriteBuffer(m_queue, m_changes, CL_FALSE, 0, sizeof(cl_int) * changes.size(), changes.data(),
+                                0, nullptr, nullptr);
+    err |= clEnqueueWriteBuffer(m_queue, m_settled, CL_FALSE, 0, sizeof(cl_int) * settled.size(), settled.data(),
+                                0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to upload batch." << std::endl;
+        return false;
+    }
+
+    // Generations are enqueued back to back; only the final state is read
+    size_t globalWorkSize[3] = { m_width, m_height, m_count };
+    cl_int width = static_cast<cl_int>(m_width);
+    cl_int height = static_cast<cl_int>(m_height);
+    err = clSetKernelArg(m_kernel, 2, sizeof(cl_mem), &m_changes);
+    err |= clSetKernelArg(m_kernel, 3, sizeof(cl_mem), &m_settled);
+    err |= clSetKernelArg(m_kernel, 4, sizeof(cl_int), &width);
+    err |= clSetKernelArg(m_kernel, 5, sizeof(cl_int), &height);
+    for (int g = 1; g <= generations && err == CL_SUCCESS; ++g) {
+        cl_int generation = g;
+        err = clSetKernelArg(m_kernel, 0, sizeof(cl_mem), &m_grids[(g - 1) % 2]);
+        err |= clSetKernelArg(m_kernel, 1, sizeof(cl_mem), &m_grids[g % 2]);
+        err |= clSetKernelArg(m_kernel, 6, sizeof(cl_int), &generation);
+        if (err == CL_SUCCESS)
+            err = clEnqueueNDRangeKernel(m_queue, m_kernel, 3, nullptr, globalWorkSize, nullptr, 0, nullptr, nullptr);
+    }
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to execute batch kernel." << std::endl;
+        clFinish(m_queue);
+        return false;
+    }
+
+    const int last = std::max(0, generations);
+    err = clEnqueueReadBuffer(m_queue, m_grids[last % 2], CL_FALSE, 0, m_cells.size(), m_cells.data(),
+                              0, nullptr, nullptr);
+    err |= clEnqueueReadBuffer(m_queue, m_settled, CL_FALSE, 0, sizeof(cl_int) * settled.size(), settled.data(),
+                               0, nullptr, nullptr);
+    err |= clEnqueueReadBuffer(m_queue, m_changes, CL_TRUE, 0, sizeof(cl_int) * changes.size(), changes.data(),
+                               0, nullptr, nullptr);
+    if (err != CL_SUCCESS) {
+        std::cerr << "Failed to read batch results." << std::endl;
+        return false;
+    }
+
+    // The flags of the last generation were not seen by another launch
+    const cl_int* lastChanges = changes.data() + 2 * m_count * (last % 3);
+    const size_t cells = m_width * m_height;
+    for (size_t w = 0; w < m_count; ++w) {
+        BatchWorldResult& result = m_results[w];
+        result = BatchWorldResult();
+        if (settled[2 * w] >= 0) {
+            result.settledAt = settled[2 * w];
+            result.period = settled[2 * w + 1];
+        } else if (last >= 1 && !lastChanges[2 * w]) {
+            result.settledAt = last - 1;
+            result.period = 1;
+        } else if (last >= 2 && !lastChanges[2 * w + 1]) {
+            result.settledAt = last - 2;
+            result.period = 2;
+        }
+        const uint8_t* world = m_cells.data() + w * cells;
+        result.population = static_cast<size_t>(std::count(world, world + cells, 1));
+    }
+    return true;
+}
+
+const std::vector<uint8_t>& WorldBatch::getCells() const {
+    return m_cells;
+}
+
+const std::vector<BatchWorldResult>& WorldBatch::getResults() const {
+    return m_results;
+}
+
+const std::string& WorldBatch::getOpenCLDeviceName() const {
+    return m_deviceName;
+}
+
+void WorldBatch::cleanupOpenCL() {
+    for (int i = 0; i < 2; ++i) {
+        if (m_grids[i]) clReleaseMemObject(m_grids[i]);
+        m_grids[i] = nullptr;
+    }
+    if (m_changes) clReleaseMemObject(m_changes);
+    if (m_settled) clReleaseMemObject(m_settled);
+    if (m_kernel) clReleaseKernel(m_kernel);
+    if (m_program) clReleaseProgram(m_program);
+    if (m_queue) clReleaseCommandQueue(m_queue);
+    if (m_context) clReleaseContext(m_context);
+    m_changes = m_settled = nullptr;
+    m_kernel = nullptr;
+    m_program = nullptr;
+    m_queue = nullptr;
+    m_context = nullptr;
+}
@@ -0,0 +1,517 @@
+#include "../include/WorldFile.h"
+#include "../include/MappedFile.h"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <climits>
+#include <new>
+
+static const char worldFileMagic[4] = { 'G', 'O', 'L', 'W' };
+static const uint32_t worldFileVersion = 1;
+// Version of files whose cells have more than two states
+static const uint32_t multiStateVersion = 2;
+
+// Rule texts are short; a longer one means a damaged header
+static const uint32_t maxRuleSize = 1024;
+
+// Payload is produced and consumed in chunks of roughly this many bytes
+static const size_t worldFileChunkSize = size_t(1) << 20;
+
+static void storeLE32(unsigned char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+static void storeLE64(unsigned char* out, uint64_t value) {
+    for (int i = 0; i < 8; ++i)
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+static uint32_t loadLE32(const unsigned char* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return value;
+}
+
+static uint64_t loadLE64(const unsigned char* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i)
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+// Cells x0 .. x0 + count - 1 of a row as one word in BitGrid's bit order
+static uint64_t packWord(const int* cells, size_t count) {
+    uint64_t word = 0;
+    for (size_t bit = 0; bit < count; ++bit) {
+        if (cells[bit])
+            word |= uint64_t(1) << bit;
+    }
+    return word;
+}
+
+static void unpackWord(uint64_t word, int* cells, size_t count) {
+    for (size_t bit = 0; bit < count; ++bit)
+        cells[bit] = static_cast<int>((word >> bit) & 1);
+}
+
+static std::vector<uint32_t> makeCrcTable() {
+    std::vector<uint32_t> table(256);
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+uint32_t worldFileCrc32(uint32_t crc, const unsigned char* data, size_t size) {
+    static const std::vector<uint32_t> table = makeCrcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+bool parseWorldFileHeader(const unsigned char* bytes, size_t size, WorldFileHeader& header) {
+    if (size < worldFileHeaderSize || std::memcmp(bytes, worldFileMagic, 4) != 0)
+        return false;
+    uint32_t version = loadLE32(bytes + 4);
+    if (version != worldFileVersion && version != multiStateVersion)
+        throw std::runtime_error("Unsupported world file version " + std::to_string(version) + ".");
+
+    header.width = loadLE64(bytes + 8);
+    header.height = loadLE64(bytes + 16);
+    header.generation = loadLE64(bytes + 24);
+    uint32_t encoding = loadLE32(bytes + 32);
+    header.payloadSize = loadLE64(bytes + 40);
+    header.checksum = loadLE32(bytes + 48);
+    uint32_t states = loadLE32(bytes + 52);
+    header.states = states == 0 ? 2 : static_cast<int>(std::min<uint32_t>(states, INT_MAX));
+    header.ruleSize = loadLE32(bytes + 56);
+    header.rule.clear();
+
+    if (encoding == 0)
+        header.format = WorldFileFormat::Binary;
+    else if (encoding == 1)
+        header.format = WorldFileFormat::BinaryRLE;
+    else
+        throw std::runtime_error("Unknown world file encoding " + std::to_string(encoding) + ".");
+
+    if (header.states < 2 || (header.states > 2) != (version == multiStateVersion))
+        throw std::runtime_error("Invalid cell state count " + std::to_string(states) + " in world file.");
+    if (header.states > 2 && header.format == WorldFileFormat::Binary)
+        throw std::runtime_error("Bit-packed world files cannot hold " + std::to_string(header.states) + " states.");
+    if (header.ruleSize > maxRuleSize)
+        throw std::runtime_error("Rule text in world file is too long.");
+    if (header.width == 0 || header.height == 0)
+        throw std::runtime_error("Invalid dimensions in file: width and height must be > 0.");
+    if (header.width > std::numeric_limits<size_t>::max() / header.height)
+        throw std::runtime_error("World dimensions in file are too large.");
+    if (header.format == WorldFileFormat::Binary
+        && header.payloadSize != header.height * ((header.width + 63) / 64) * 8)
+        throw std::runtime_error("Bit-packed payload size does not match the world dimensions.");
+    return true;
+}
+
+static void storeHeader(unsigned char* bytes, const WorldFileHeader& header) {
+    std::memset(bytes, 0, worldFileHeaderSize);
+    std::memcpy(bytes, worldFileMagic, 4);
+    storeLE32(bytes + 4, header.states > 2 ? multiStateVersion : worldFileVersion);
+    storeLE64(bytes + 8, header.width);
+    storeLE64(bytes + 16, header.height);
+    storeLE64(bytes + 24, header.generation);
+    storeLE32(bytes + 32, header.format == WorldFileFormat::BinaryRLE ? 1 : 0);
+    storeLE64(bytes + 40, header.payloadSize);
+    storeLE32(bytes + 48, header.checksum);
+    storeLE32(bytes + 52, static_cast<uint32_t>(header.states));
+    storeLE32(bytes + 56, static_cast<uint32_t>(header.rule.size()));
+}
+
+static void writeHeader(std::ofstream& out, const WorldFileHeader& header) {
+    unsigned char bytes[worldFileHeaderSize];
+    storeHeader(bytes, header);
+    out.write(reinterpret_cast<const char*>(bytes), worldFileHeaderSize);
+}
+
+// Buffers payload bytes and hands them to the stream a chunk at a time,
+// keeping the running size and checksum
+class PayloadWriter {
+public:
+    explicit PayloadWriter(std::ofstream& out) : m_out(out), m_size(0), m_crc(0) {
+        m_buffer.reserve(worldFileChunkSize + 64);
+    }
+
+    void putWord(uint64_t word) {
+        size_t offset = m_buffer.size();
+        m_buffer.resize(offset + 8);
+        storeLE64(&m_buffer[offset], word);
+    }
+
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            m_buffer.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        m_buffer.push_back(static_cast<unsigned char>(value));
+    }
+
+    void flushIfFull() {
+        if (m_buffer.size() >= worldFileChunkSize)
+            flush();
+    }
+
+    void flush() {
+        if (m_buffer.empty())
+            return;
+        m_crc = worldFileCrc32(m_crc, m_buffer.data(), m_buffer.size());
+        m_out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+        m_size += m_buffer.size();
+        m_buffer.clear();
+    }
+
+    uint64_t size() const { return m_size; }
+    uint32_t checksum() const { return m_crc; }
+
+private:
+    std::ofstream& m_out;
+    std::vector<unsigned char> m_buffer;
+    uint64_t m_size;
+    uint32_t m_crc;
+};
+
+static void saveText(const std::string& filename, const std::vector<int>& cells, size_t width, size_t height) {
+    std::ofstream ofs(filename.c_str());
+    if (!ofs)
+        throw std::runtime_error("Could not open file for writing: " + filename);
+
+    ofs << width << " " << height << "\n";
+
+    // Rows are formatted into one string so the stream sees a single write each
+    std::string row;
+    for (size_t y = 0; y < height; ++y) {
+        row.clear();
+        for (size_t x = 0; x < width; ++x) {
+            row += std::to_string(cells[y * width + x]);
+            row += (x < width - 1) ? ' ' : '\n';
+        }
+        ofs << row;
+    }
+
+    if (!ofs)
+        throw std::runtime_error("Failed to write file: " + filename);
+}
+
+void saveWorldFile(const std::string& filename, const std::vector<int>& cells,
+                   size_t width, size_t height, WorldFileFormat format,
+                   uint64_t generation, int states, const std::string& rule) {
+    if (format == WorldFileFormat::Text) {
+        saveText(filename, cells, width, height);
+        return;
+    }
+    if (states < 2)
+        throw std::invalid_argument("A world needs at least two cell states.");
+    if (states > 2 && format == WorldFileFormat::Binary)
+        throw std::invalid_argument("Bit-packed world files hold two states; save worlds with " +
+                                    std::to_string(states) + " states as RLE or text.");
+    if (rule.size() > maxRuleSize)
+        throw std::invalid_argument("Rule text is too long for a world file.");
+
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Could not open file for writing: " + filename);
+
+    WorldFileHeader header;
+    header.width = width;
+    header.height = height;
+    header.generation = generation;
+    header.format = format;
+    header.payloadSize = 0;
+    header.checksum = 0;
+    header.states = states;
+    header.rule = rule;
+    // Placeholder; size and checksum are only known once the payload is out
+    writeHeader(out, header);
+
+    PayloadWriter payload(out);
+    if (format == WorldFileFormat::Binary) {
+        for (size_t y = 0; y < height; ++y) {
+            const int* row = &cells[y * width];
+            for (size_t x0 = 0; x0 < width; x0 += 64)
+                payload.putWord(packWord(row + x0, width - x0 < 64 ? width - x0 : 64));
+            payload.flushIfFull();
+        }
+    } else if (states > 2) {
+        // Each run of equal cells over the row-major grid is its length
+        // followed by its state
+        for (size_t begin = 0; begin < width * height;) {
+            int state = cells[begin];
+            if (state < 0 || state >= states)
+                throw std::invalid_argument("Cell state " + std::to_string(state) + " does not fit a world of " +
+                                            std::to_string(states) + " states.");
+            size_t end = begin + 1;
+            while (end < width * height && cells[end] == state)
+                ++end;
+            payload.putVarint(end - begin);
+            payload.putVarint(static_cast<uint64_t>(state));
+            payload.flushIfFull();
+            begin = end;
+        }
+    } else {
+        // Runs alternate dead, alive, dead, ... over the row-major grid,
+        // so a grid starting with a live cell begins with an empty run
+        bool alive = false;
+        uint64_t run = 0;
+        for (size_t i = 0; i < width * height; ++i) {
+            if ((cells[i] != 0) != alive) {
+                payload.putVarint(run);
+                payload.flushIfFull();
+                alive = !alive;
+                run = 0;
+            }
+            ++run;
+        }
+        payload.putVarint(run);
+    }
+    payload.flush();
+
+    header.payloadSize = payload.size();
+    header.checksum = payload.checksum();
+    out.write(rule.data(), static_cast<std::streamsize>(rule.size()));
+    out.seekp(0);
+    writeHeader(out, header);
+
+    if (!out)
+        throw std::runtime_error("Failed to write file: " + filename);
+}
+
+// Cells of a world whose dimensions come from a file. A world this machine
+// cannot hold is reported as such instead of as a bare std::bad_alloc.
+static void allocateCells(std::vector<int>& cells, uint64_t width, uint64_t height) {
+    std::string size = std::to_string(width) + " x " + std::to_string(height);
+    if (width > cells.max_size() / height)
+        throw std::runtime_error("World of " + size + " cells is too large.");
+    try {
+        cells.assign(static_cast<size_t>(width * height), 0);
+    } catch (const std::bad_alloc&) {
+        throw std::runtime_error("World of " + size + " cells is too large.");
+    }
+}
+
+static void loadText(std::ifstream& infile, WorldFileHeader& header, std::vector<int>& cells) {
+    size_t width = 0;
+    size_t height = 0;
+    if (!(infile >> width >> height))
+        throw std::runtime_error("Invalid file format: width and height not found.");
+
+    if (width == 0 || height == 0)
+        throw std::runtime_error("Invalid dimensions in file: width and height must be > 0.");
+
+    allocateCells(cells, width, height);
+    for (size_t i = 0; i < width * height; ++i) {
+        int cellValue = 0;
+        if (!(infile >> cellValue))
+            throw std::runtime_error("Not enough cell values in file. Expected " +
+                                     std::to_string(width * height) + " values.");
+        cells[i] = cellValue;
+    }
+
+    header.width = width;
+    header.height = height;
+    header.generation = 0;
+    header.format = WorldFileFormat::Text;
+    header.payloadSize = 0;
+    header.checksum = 0;
+    header.states = 2;
+    header.ruleSize = 0;
+    header.rule.clear();
+}
+
+static void loadBinaryPayload(std::ifstream& infile, WorldFileHeader& header, std::vector<int>& cells) {
+    const size_t width = static_cast<size_t>(header.width);
+    const size_t height = static_cast<size_t>(header.height);
+    const size_t cellCount = width * height;
+
+    // A file shorter than its header claims is rejected before the world
+    // is allocated
+    std::streampos payloadStart = infile.tellg();
+    infile.seekg(0, std::ios::end);
+    uint64_t available = static_cast<uint64_t>(infile.tellg() - payloadStart);
+    infile.seekg(payloadStart);
+    if (available < header.payloadSize || available - header.payloadSize < header.ruleSize)
+        throw std::runtime_error("World file is truncated.");
+    allocateCells(cells, width, height);
+
+    std::vector<unsigned char> chunk;
+    uint64_t remaining = header.payloadSize;
+    uint32_t crc = 0;
+
+    // Bit-packed state: next row and word within it
+    const size_t wordsPerRow = (width + 63) / 64;
+    size_t y = 0;
+    size_t wordInRow = 0;
+
+    // RLE state: next cell, current run colour and a varint split across
+    // chunks; multi-state runs keep their length until the state follows
+    size_t cell = 0;
+    bool alive = false;
+    bool stateNext = false;
+    uint64_t runLength = 0;
+    uint64_t pending = 0;
+    unsigned shift = 0;
+
+    while (remaining > 0) {
+        size_t chunkSize = remaining < worldFileChunkSize ? static_cast<size_t>(remaining) : worldFileChunkSize;
+        if (header.format == WorldFileFormat::Binary)
+            chunkSize -= chunkSize % 8;
+        chunk.resize(chunkSize);
+        if (!infile.read(reinterpret_cast<char*>(chunk.data()), chunkSize))
+            throw std::runtime_error("World file is truncated.");
+        crc = worldFileCrc32(crc, chunk.data(), chunkSize);
+        remaining -= chunkSize;
+
+        if (header.format == WorldFileFormat::Binary) {
+            for (size_t offset = 0; offset < chunkSize; offset += 8) {
+                size_t x0 = wordInRow * 64;
+                unpackWord(loadLE64(&chunk[offset]), &cells[y * width + x0], width - x0 < 64 ? width - x0 : 64);
+                if (++wordInRow == wordsPerRow) {
+                    wordInRow = 0;
+                    ++y;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < chunkSize; ++i) {
+                if (shift > 63)
+                    throw std::runtime_error("Malformed run length in world file.");
+                pending |= static_cast<uint64_t>(chunk[i] & 0x7F) << shift;
+                if (chunk[i] & 0x80) {
+                    shift += 7;
+                    continue;
+                }
+                if (header.states > 2 && stateNext) {
+                    if (pending >= static_cast<uint64_t>(header.states))
+                        throw std::runtime_error("Cell state in world file exceeds its state count.");
+                    std::fill(cells.begin() + cell, cells.begin() + cell + runLength, static_cast<int>(pending));
+                    cell += static_cast<size_t>(runLength);
+                    stateNext = false;
+                } else if (pending > cellCount - cell) {
+                    throw std::runtime_error("Run lengths in world file exceed the world size.");
+                } else if (header.states > 2) {
+                    runLength = pending;
+                    stateNext = true;
+                } else {
+                    if (alive)
+                        std::fill(cells.begin() + cell, cells.begin() + cell + pending, 1);
+                    cell += static_cast<size_t>(pending);
+                    alive = !alive;
+                }
+                pending = 0;
+                shift = 0;
+            }
+        }
+    }
+
+    if (header.format == WorldFileFormat::BinaryRLE && (cell != cellCount || shift != 0 || stateNext))
+        throw std::runtime_error("Run lengths in world file do not cover the world.");
+    if (crc != header.checksum)
+        throw std::runtime_error("World file checksum mismatch.");
+
+    header.rule.resize(header.ruleSize);
+    if (header.ruleSize > 0 && !infile.read(&header.rule[0], header.ruleSize))
+        throw std::runtime_error("World file is truncated.");
+}
+
+WorldFileHeader loadWorldFile(const std::string& filename, std::vector<int>& cells) {
+    std::ifstream infile(filename, std::ios::binary);
+    if (!infile.is_open())
+        throw std::runtime_error("Failed to open file: " + filename);
+
+    WorldFileHeader header;
+    unsigned char bytes[worldFileHeaderSize];
+    infile.read(reinterpret_cast<char*>(bytes), worldFileHeaderSize);
+    size_t got = static_cast<size_t>(infile.gcount());
+
+    if (parseWorldFileHeader(bytes, got, header)) {
+        loadBinaryPayload(infile, header, cells);
+    } else {
+        infile.clear();
+        infile.seekg(0);
+        loadText(infile, header, cells);
+    }
+    return header;
+}
+
+bool mapWorldFile(const std::string& filename, MappedFile& file, WorldFileHeader& header) {
+    file.openRead(filename);
+    if (!parseWorldFileHeader(file.data(), file.size(), header) || header.format != WorldFileFormat::Binary) {
+        file.close();
+        return false;
+    }
+    if (file.size() - worldFileHeaderSize < header.payloadSize
+        || file.size() - worldFileHeaderSize - header.payloadSize < header.ruleSize) {
+        file.close();
+        throw std::runtime_error("World file is truncated.");
+    }
+    header.rule.assign(reinterpret_cast<const char*>(file.data() + worldFileHeaderSize + header.payloadSize),
+                       header.ruleSize);
+    return true;
+}
+
+void verifyMappedWorld(const MappedFile& file, const WorldFileHeader& header) {
+    const unsigned char* payload = file.data() + worldFileHeaderSize;
+    if (worldFileCrc32(0, payload, static_cast<size_t>(header.payloadSize)) != header.checksum)
+        throw std::runtime_error("World file checksum mismatch.");
+}
+
+void unpackMappedWorld(const MappedFile& file, const WorldFileHeader& header, std::vector<int>& cells) {
+    const size_t width = static_cast<size_t>(header.width);
+    const size_t height = static_cast<size_t>(header.height);
+    const size_t rowBytes = (width + 63) / 64 * 8;
+    const unsigned char* payload = file.data() + worldFileHeaderSize;
+
+    // Checksum and unpack row by row so each page is only brought in once
+    allocateCells(cells, width, height);
+    uint32_t crc = 0;
+    for (size_t y = 0; y < height; ++y) {
+        const unsigned char* row = payload + y * rowBytes;
+        crc = worldFileCrc32(crc, row, rowBytes);
+        for (size_t x0 = 0; x0 < width; x0 += 64)
+            unpackWord(loadLE64(row + x0 / 8), &cells[y * width + x0], width - x0 < 64 ? width - x0 : 64);
+    }
+    if (crc != header.checksum)
+        throw std::runtime_error("World file checksum mismatch.");
+}
+
+void saveMappedWorldFile(const std::string& filename, const std::vector<int>& cells,
+                         size_t width, size_t height, uint64_t generation, const std::string& rule) {
+    if (rule.size() > maxRuleSize)
+        throw std::invalid_argument("Rule text is too long for a world file.");
+    const size_t rowBytes = (width + 63) / 64 * 8;
+
+    WorldFileHeader header;
+    header.width = width;
+    header.height = height;
+    header.generation = generation;
+    header.format = WorldFileFormat::Binary;
+    header.payloadSize = rowBytes * height;
+    header.checksum = 0;
+    header.states = 2;
+    header.rule = rule;
+
+    MappedFile file;
+    file.create(filename, worldFileHeaderSize + static_cast<size_t>(header.payloadSize) + rule.size());
+    unsigned char* payload = file.data() + worldFileHeaderSize;
+    for (size_t y = 0; y < height; ++y) {
+        unsigned char* row = payload + y * rowBytes;
+        for (size_t x0 = 0; x0 < width; x0 += 64)
+            storeLE64(row + x0 / 8, packWord(&cells[y * width + x0], width - x0 < 64 ? width - x0 : 64));
+        header.checksum = worldFileCrc32(header.checksum, row, rowBytes);
+    }
+    std::memcpy(payload + header.payloadSize, rule.data(), rule.size());
+    storeHeader(file.data(), header);
+    file.flush();
+}
@@ -0,0 +1,569 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include "../include/GameOfLife.h"
+#include "../include/CheckpointWriter.h"
+#include "../include/SimdLife.h"
+#include "../include/WorldBatch.h"
+
+// Headless runner for batch jobs. Loads or generates a world, runs one
+// engine to completion with optional background checkpoints, writes the
+// final world and prints a machine-readable summary. Nothing is read from
+// stdin and nothing is rendered, so it runs under any job scheduler; with
+// --resume a restarted job continues from its last checkpoint. With
+// --worlds it instead sweeps many small random worlds in one WorldBatch
+// and reports how each of them ended.
+
+static const char* engineNames[] = { "scalar", "simd", "threaded", "bitpacked", "sparse", "hashlife", "opencl", "multi" };
+
+struct Options {
+    std::string loadFile;
+    size_t width = 1024;
+    size_t height = 1024;
+    double density = 0.3;
+    unsigned seed = 1;
+    std::string engine = "bitpacked";
+    int generations = 100;
+    std::string rule;
+    unsigned threads = 0;
+    std::string simdIsa;
+    std::string device;
+    unsigned subDevices = 0;   // multi: split each device into this many sub-devices
+    std::string kernel = "naive";
+    int blockDepth = 4;
+    std::string storage = "int";
+    std::string checkpointFile;
+    int checkpointGenerations = 0;
+    double checkpointSeconds = 0;
+    WorldFileFormat checkpointFormat = WorldFileFormat::BinaryRLE;
+    bool resume = false;
+    std::string outputFile;
+    WorldFileFormat outputFormat = WorldFileFormat::Binary;
+    bool outputFormatSet = false;   // multi-state worlds default to RLE instead
+    std::string statsFormat = "json";
+    std::string statsFile;
+    size_t worlds = 0;
+    std::string resultsFile;
+};
+
+static void printUsage() {
+    std::cerr << "Usage: batch_life [--load FILE | --width W --height H --density D --seed S]\n"
+              << "                  [--engine scalar|simd|threaded|bitpacked|sparse|hashlife|opencl|multi]\n"
+              << "                  [--generations G] [--rule RULE] [--threads K] [--simd ISA] [--device SEL] [--sub-devices K]\n"
+              << "                  [--kernel naive|tiled|blocked] [--block-depth K] [--storage int|uchar|bits]\n"
+              << "                  [--checkpoint FILE --checkpoint-every N|Ts [--checkpoint-format rle|binary] [--resume]]\n"
+              << "                  [--output FILE [--format text|binary|rle]] [--stats json|csv|text] [--stats-file FILE]\n"
+              << "       batch_life --worlds N [--width W --height H --density D --seed S] [--engine threaded|opencl]\n"
+              << "                  [--generations G] [--rule RULE] [--threads K] [--device SEL] [--results FILE]\n"
+              << "                  [--stats json|csv|text] [--stats-file FILE]\n";
+}
+
+static bool parseFormat(const std::string& name, WorldFileFormat& format) {
+    if (name == "text") {
+        format = WorldFileFormat::Text;
+    } else if (name == "rle") {
+        format = WorldFileFormat::BinaryRLE;
+    } else if (name == "binary") {
+        format = WorldFileFormat::Binary;
+    } else {
+        std::cerr << "Unknown format '" << name << "'.\n";
+        return false;
+    }
+    return true;
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "--load" && hasValue) {
+            options.loadFile = argv[++i];
+        } else if (arg == "--width" && hasValue) {
+            options.width = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--height" && hasValue) {
+            options.height = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--density" && hasValue) {
+            options.density = std::atof(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--engine" && hasValue) {
+            options.engine = argv[++i];
+        } else if (arg == "--generations" && hasValue) {
+            options.generations = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--rule" && hasValue) {
+            options.rule = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--simd" && hasValue) {
+            options.simdIsa = argv[++i];
+        } else if (arg == "--device" && hasValue) {
+            options.device = argv[++i];
+        } else if (arg == "--sub-devices" && hasValue) {
+            options.subDevices = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--kernel" && hasValue) {
+            options.kernel = argv[++i];
+        } else if (arg == "--block-depth" && hasValue) {
+            options.blockDepth = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--storage" && hasValue) {
+            options.storage = argv[++i];
+        } else if (arg == "--checkpoint" && hasValue) {
+            options.checkpointFile = argv[++i];
+        } else if (arg == "--checkpoint-every" && hasValue) {
+            // "<n>" counts generations, "<t>s" seconds
+            std::string interval = argv[++i];
+            if (!interval.empty() && interval.back() == 's')
+                options.checkpointSeconds = std::atof(interval.c_str());
+            else
+                options.checkpointGenerations = std::atoi(interval.c_str());
+        } else if (arg == "--checkpoint-format" && hasValue) {
+            if (!parseFormat(argv[++i], options.checkpointFormat))
+                return false;
+        } else if (arg == "--output" && hasValue) {
+            options.outputFile = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            if (!parseFormat(argv[++i], options.outputFormat))
+                return false;
+            options.outputFormatSet = true;
+        } else if (arg == "--stats" && hasValue) {
+            options.statsFormat = argv[++i];
+        } else if (arg == "--stats-file" && hasValue) {
+            options.statsFile = argv[++i];
+        } else if (arg == "--worlds" && hasValue) {
+            options.worlds = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--results" && hasValue) {
+            options.resultsFile = argv[++i];
+        } else {
+            printUsage();
+            return false;
+        }
+    }
+
+    if (std::find(std::begin(engineNames), std::end(engineNames), options.engine) == std::end(engineNames)) {
+        std::cerr << "Unknown engine '" << options.engine << "'.\n";
+        return false;
+    }
+    if (options.statsFormat != "json" && options.statsFormat != "csv" && options.statsFormat != "text") {
+        std::cerr << "Unknown stats format '" << options.statsFormat << "'.\n";
+        return false;
+    }
+    if (options.kernel != "naive" && options.kernel != "tiled" && options.kernel != "blocked") {
+        std::cerr << "Unknown kernel '" << options.kernel << "'.\n";
+        return false;
+    }
+    if (options.storage != "int" && options.storage != "uchar" && options.storage != "bits") {
+        std::cerr << "Unknown storage '" << options.storage << "'.\n";
+        return false;
+    }
+    if (options.subDevices > 1 && options.engine != "multi") {
+        std::cerr << "--sub-devices needs --engine multi.\n";
+        return false;
+    }
+    bool interval = options.checkpointGenerations > 0 || options.checkpointSeconds > 0;
+    if (interval != !options.checkpointFile.empty()) {
+        std::cerr << "--checkpoint and --checkpoint-every go together.\n";
+        return false;
+    }
+    if (options.checkpointFormat == WorldFileFormat::Text) {
+        std::cerr << "--checkpoint-format takes rle or binary; text files cannot keep the generation.\n";
+        return false;
+    }
+    if (options.resume && options.checkpointFile.empty()) {
+        std::cerr << "--resume needs --checkpoint.\n";
+        return false;
+    }
+    if (options.loadFile.empty() && (options.width == 0 || options.height == 0)) {
+        std::cerr << "World dimensions must be > 0.\n";
+        return false;
+    }
+    if (options.worlds > 0) {
+        if (options.engine != "threaded" && options.engine != "opencl") {
+            std::cerr << "--worlds runs on the threaded or opencl engine.\n";
+            return false;
+        }
+        if (!options.loadFile.empty() || !options.checkpointFile.empty() || !options.outputFile.empty()) {
+            std::cerr << "--worlds generates its worlds and keeps no world files.\n";
+            return false;
+        }
+    } else if (!options.resultsFile.empty()) {
+        std::cerr << "--results needs --worlds.\n";
+        return false;
+    }
+    return true;
+}
+
+// Header of a binary world file; false for text files, which have none
+static bool storedHeader(const std::string& filename, WorldFileHeader& header) {
+    unsigned char bytes[worldFileHeaderSize];
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    return in.read(reinterpret_cast<char*>(bytes), sizeof(bytes))
+        && parseWorldFileHeader(bytes, sizeof(bytes), header);
+}
+
+static uint64_t storedGeneration(const std::string& filename) {
+    WorldFileHeader header;
+    return storedHeader(filename, header) ? header.generation : 0;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Stat {
+    std::string name;
+    std::string value;
+    bool quoted;
+};
+
+static void addStat(std::vector<Stat>& stats, const std::string& name, double value) {
+    std::ostringstream text;
+    text << std::setprecision(9) << value;
+    stats.push_back(Stat{ name, text.str(), false });
+}
+
+static void addStat(std::vector<Stat>& stats, const std::string& name, const std::string& value) {
+    stats.push_back(Stat{ name, value, true });
+}
+
+static std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Rule strings like "R5,C0,..." contain commas
+static std::string csvString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static void writeStats(std::ostream& out, const std::vector<Stat>& stats, const std::string& format) {
+    if (format == "json") {
+        out << "{\n";
+        for (size_t i = 0; i < stats.size(); ++i)
+            out << "  " << jsonString(stats[i].name) << ": "
+                << (stats[i].quoted ? jsonString(stats[i].value) : stats[i].value)
+                << (i + 1 < stats.size() ? ",\n" : "\n");
+        out << "}\n";
+    } else if (format == "csv") {
+        for (size_t i = 0; i < stats.size(); ++i)
+            out << stats[i].name << (i + 1 < stats.size() ? "," : "\n");
+        for (size_t i = 0; i < stats.size(); ++i)
+            out << (stats[i].quoted ? csvString(stats[i].value) : stats[i].value) << (i + 1 < stats.size() ? "," : "\n");
+    } else {
+        for (const Stat& stat : stats)
+            out << stat.name << ": " << stat.value << "\n";
+    }
+}
+
+static bool writeSummary(const std::vector<Stat>& stats, const Options& options) {
+    if (options.statsFile.empty()) {
+        writeStats(std::cout, stats, options.statsFormat);
+        return true;
+    }
+    std::ofstream out(options.statsFile.c_str());
+    writeStats(out, stats, options.statsFormat);
+    if (!out) {
+        std::cerr << "Could not write " << options.statsFile << ".\n";
+        return false;
+    }
+    return true;
+}
+
+// Advances the world by up to n generations; false on an engine failure
+static bool evolve(GameOfLife& world, const Options& options, int n) {
+    const std::string& engine = options.engine;
+    if (engine == "scalar") {
+        for (int g = 0; g < n; ++g)
+            world.evolveScalar();
+    } else if (engine == "simd") {
+        world.evolveSimd(n);
+    } else if (engine == "threaded") {
+        world.evolveThreaded(n, options.threads);
+    } else if (engine == "bitpacked") {
+        world.evolveBitPacked(n);
+    } else if (engine == "sparse") {
+        world.evolveSparse(n);
+    } else if (engine == "hashlife") {
+        world.evolveHashLife(static_cast<uint64_t>(n));
+    } else if (engine == "opencl") {
+        return world.evolveOpenCL(n);
+    } else if (engine == "multi") {
+        return world.evolveMultiDevice(n, options.device, options.subDevices);
+    }
+    return true;
+}
+
+static void configure(GameOfLife& world, const Options& options) {
+    if (!options.rule.empty())
+        world.setRule(parseRule(options.rule));
+    if (!options.simdIsa.empty())
+        world.setSimdIsa(options.simdIsa == "auto" ? SimdLife::bestIsa() : SimdLife::parseIsa(options.simdIsa));
+    if (options.engine == "opencl") {
+        world.setOpenCLDevice(options.device);
+        if (options.kernel == "tiled")
+            world.setKernelVariant(GameOfLife::KernelVariant::Tiled);
+        else if (options.kernel == "blocked")
+            world.setKernelVariant(GameOfLife::KernelVariant::TemporalBlocked);
+        world.setTemporalBlockDepth(options.blockDepth);
+        if (options.storage == "uchar")
+            world.setCellStorage(GameOfLife::CellStorage::UChar);
+        else if (options.storage == "bits")
+            world.setCellStorage(GameOfLife::CellStorage::BitPacked);
+    }
+}
+
+static int run(const Options& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    // The run ends at the same generation whether or not it was resumed
+    std::unique_ptr<GameOfLife> world;
+    bool resumed = false;
+    bool generated = false;
+    uint64_t targetGeneration = static_cast<uint64_t>(options.generations);
+    if (!options.loadFile.empty())
+        targetGeneration += storedGeneration(options.loadFile);
+    if (options.resume && std::filesystem::exists(options.checkpointFile)) {
+        world.reset(new GameOfLife(options.checkpointFile, true));
+        resumed = true;
+    } else if (!options.loadFile.empty()) {
+        world.reset(new GameOfLife(options.loadFile, true));
+    } else {
+        // OpenCL worlds are generated on the device during setup
+        world.reset(new GameOfLife(options.width, options.height));
+        generated = true;
+        if (options.engine != "opencl")
+            world->randomize(options.density, options.seed);
+    }
+    // A resumed run continues under the checkpoint's rule. Checkpoints
+    // written before the rule was stored only keep the state count, so a
+    // multi-state one has to be given its rule again.
+    const Rule resumedRule = world->getRule();
+    WorldFileHeader checkpointHeader;
+    const bool ruleStored = resumed && storedHeader(options.checkpointFile, checkpointHeader)
+                            && checkpointHeader.ruleSize > 0;
+    if (resumed && !ruleStored && resumedRule.states > 2 && options.rule.empty())
+        throw std::invalid_argument("Checkpoint " + options.checkpointFile + " holds "
+                                    + std::to_string(resumedRule.states)
+                                    + " cell states but no rule; resume it with the run's --rule.");
+    configure(*world, options);
+    if (resumed && ruleStored && world->getRule() != resumedRule)
+        throw std::runtime_error("Checkpoint " + options.checkpointFile + " was written under rule "
+                                 + ruleToString(resumedRule) + ", not " + ruleToString(world->getRule()) + ".");
+    if (resumed && world->getRule().states != resumedRule.states)
+        throw std::runtime_error("Checkpoint " + options.checkpointFile + " holds " + std::to_string(resumedRule.states)
+                                 + " cell states, but rule " + ruleToString(world->getRule()) + " has "
+                                 + std::to_string(world->getRule().states) + ".");
+    if (!options.checkpointFile.empty() && options.checkpointFormat == WorldFileFormat::Binary
+        && world->getRule().states > 2)
+        throw std::invalid_argument("Bit-packed checkpoints hold two states; use --checkpoint-format rle for rule "
+                                    + ruleToString(world->getRule()) + ".");
+    WorldFileFormat outputFormat = options.outputFormat;
+    if (!options.outputFile.empty() && outputFormat == WorldFileFormat::Binary && world->getRule().states > 2) {
+        if (options.outputFormatSet)
+            throw std::invalid_argument("Bit-packed world files hold two states; use --format rle or text for rule "
+                                        + ruleToString(world->getRule()) + ".");
+        outputFormat = WorldFileFormat::BinaryRLE;
+    }
+    const uint64_t startGeneration = world->getGeneration();
+    const int generations = targetGeneration > startGeneration
+                          ? static_cast<int>(targetGeneration - startGeneration) : 0;
+    double loadSeconds = secondsSince(start);
+
+    // Device initialization and the upload (or the random fill) are timed
+    // apart from evolution
+    double setupSeconds = 0;
+    if (options.engine == "opencl" || options.engine == "multi") {
+        auto setupStart = std::chrono::steady_clock::now();
+        bool deviceFill = generated && options.engine == "opencl";
+        if ((deviceFill && !world->randomizeOpenCL(options.density, options.seed)) || !evolve(*world, options, 0)) {
+            std::cerr << "Engine '" << options.engine << "' could not be initialized.\n";
+            return 1;
+        }
+        setupSeconds = secondsSince(setupStart);
+    }
+
+    std::unique_ptr<CheckpointWriter> checkpoints;
+    CheckpointSchedule schedule(options.checkpointGenerations, options.checkpointSeconds);
+    if (!options.checkpointFile.empty())
+        checkpoints.reset(new CheckpointWriter(options.checkpointFile, options.checkpointFormat));
+
+    // Without checkpoints the engine gets the whole run in one call
+    double evolveSeconds = 0;
+    double checkpointSeconds = 0;
+    int done = 0;
+    schedule.start();
+    while (done < generations) {
+        int chunk = checkpoints ? schedule.generationsUntilDue(world->getGeneration(), generations - done)
+                                : generations - done;
+        auto chunkStart = std::chrono::steady_clock::now();
+        if (!evolve(*world, options, chunk)) {
+            std::cerr << "Engine '" << options.engine << "' failed at generation " << world->getGeneration() << ".\n";
+            return 1;
+        }
+        double seconds = secondsSince(chunkStart);
+        evolveSeconds += seconds;
+        schedule.recordChunk(chunk, seconds);
+        done += chunk;
+
+        if (checkpoints && schedule.isDue(world->getGeneration())) {
+            // The copy (and an OpenCL readback) is all the run waits for
+            auto submitStart = std::chrono::steady_clock::now();
+            checkpoints->submit(world->getCurrentGrid(), world->getWidth(), world->getHeight(), world->getGeneration(),
+                                world->getRule());
+            checkpointSeconds += secondsSince(submitStart);
+            schedule.markSaved();
+        }
+    }
+
+    CheckpointWriter::Stats checkpointStats = CheckpointWriter::Stats();
+    if (checkpoints) {
+        auto flushStart = std::chrono::steady_clock::now();
+        checkpoints->flush();
+        checkpointSeconds += secondsSince(flushStart);
+        checkpointStats = checkpoints->getStats();
+    }
+
+    double saveSeconds = 0;
+    if (!options.outputFile.empty()) {
+        auto saveStart = std::chrono::steady_clock::now();
+        world->saveToFile(options.outputFile, outputFormat);
+        saveSeconds = secondsSince(saveStart);
+    }
+
+    const std::vector<int>& grid = world->getCurrentGrid();
+    size_t population = grid.size() - static_cast<size_t>(std::count(grid.begin(), grid.end(), 0));
+    double cellUpdates = static_cast<double>(world->getWidth()) * world->getHeight() * generations;
+
+    std::vector<Stat> stats;
+    addStat(stats, "engine", options.engine);
+    addStat(stats, "rule", ruleToString(world->getRule()));
+    addStat(stats, "width", static_cast<double>(world->getWidth()));
+    addStat(stats, "height", static_cast<double>(world->getHeight()));
+    addStat(stats, "resumed", resumed ? 1.0 : 0.0);
+    addStat(stats, "start_generation", static_cast<double>(startGeneration));
+    addStat(stats, "final_generation", static_cast<double>(world->getGeneration()));
+    addStat(stats, "generations", generations);
+    addStat(stats, "final_population", static_cast<double>(population));
+    addStat(stats, "generations_per_second", evolveSeconds > 0 ? generations / evolveSeconds : 0.0);
+    addStat(stats, "cell_updates_per_second", evolveSeconds > 0 ? cellUpdates / evolveSeconds : 0.0);
+    addStat(stats, "load_seconds", loadSeconds);
+    addStat(stats, "setup_seconds", setupSeconds);
+    addStat(stats, "evolve_seconds", evolveSeconds);
+    addStat(stats, "checkpoint_wait_seconds", checkpointSeconds);
+    addStat(stats, "checkpoint_write_seconds", checkpointStats.writeSeconds);
+    addStat(stats, "checkpoints_written", static_cast<double>(checkpointStats.written));
+    addStat(stats, "checkpoints_replaced", static_cast<double>(checkpointStats.replaced));
+    addStat(stats, "save_seconds", saveSeconds);
+    if (options.engine == "opencl") {
+        addStat(stats, "opencl_device", world->getOpenCLStartup().deviceName);
+        addStat(stats, "opencl_init_seconds", world->getOpenCLStartup().initMs / 1000.0);
+    }
+    if (options.engine == "multi")
+        addStat(stats, "strips", static_cast<double>(world->getMultiDeviceStrips().size()));
+    addStat(stats, "total_seconds", secondsSince(start));
+
+    return writeSummary(stats, options) ? 0 : 1;
+}
+
+// Sweep mode: every world is its own random soup of the same seed
+static int runBatch(const Options& options) {
+    auto start = std::chrono::steady_clock::now();
+    Rule rule = options.rule.empty() ? Rule() : parseRule(options.rule);
+    WorldBatch batch(options.width, options.height, options.worlds, rule);
+    batch.randomize(options.density, options.seed);
+    double loadSeconds = secondsSince(start);
+
+    double setupSeconds = 0;
+    if (options.engine == "opencl") {
+        auto setupStart = std::chrono::steady_clock::now();
+        if (!batch.initializeOpenCL(options.device)) {
+            std::cerr << "Engine 'opencl' could not be initialized.\n";
+            return 1;
+        }
+        setupSeconds = secondsSince(setupStart);
+    }
+
+    auto evolveStart = std::chrono::steady_clock::now();
+    if (options.engine == "opencl") {
+        if (!batch.evolveOpenCL(options.generations)) {
+            std::cerr << "Engine 'opencl' failed.\n";
+            return 1;
+        }
+    } else {
+        batch.evolveThreaded(options.generations, options.threads);
+    }
+    double evolveSeconds = secondsSince(evolveStart);
+
+    const std::vector<BatchWorldResult>& results = batch.getResults();
+    size_t settled = 0;
+    double population = 0;
+    for (const BatchWorldResult& result : results) {
+        settled += result.settledAt >= 0 ? 1 : 0;
+        population += static_cast<double>(result.population);
+    }
+
+    if (!options.resultsFile.empty()) {
+        std::ofstream out(options.resultsFile.c_str());
+        out << "world,population,settled_at,period\n";
+        for (size_t i = 0; i < results.size(); ++i)
+            out << i << "," << results[i].population << "," << results[i].settledAt << "," << results[i].period << "\n";
+        if (!out) {
+            std::cerr << "Could not write " << options.resultsFile << ".\n";
+            return 1;
+        }
+    }
+
+    double cellUpdates = static_cast<double>(options.width) * options.height * options.worlds * options.generations;
+    std::vector<Stat> stats;
+    addStat(stats, "engine", options.engine);
+    addStat(stats, "rule", ruleToString(rule));
+    addStat(stats, "width", static_cast<double>(options.width));
+    addStat(stats, "height", static_cast<double>(options.height));
+    addStat(stats, "worlds", static_cast<double>(options.worlds));
+    addStat(stats, "seed", options.seed);
+    addStat(stats, "generations", options.generations);
+    addStat(stats, "settled_worlds", static_cast<double>(settled));
+    addStat(stats, "mean_population", population / results.size());
+    addStat(stats, "cell_updates_per_second", evolveSeconds > 0 ? cellUpdates / evolveSeconds : 0.0);
+    addStat(stats, "load_seconds", loadSeconds);
+    addStat(stats, "setup_seconds", setupSeconds);
+    addStat(stats, "evolve_seconds", evolveSeconds);
+    if (options.engine == "opencl")
+        addStat(stats, "opencl_device", batch.getOpenCLDeviceName());
+    addStat(stats, "total_seconds", secondsSince(start));
+    return writeSummary(stats, options) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+    try {
+        if (options.worlds > 0)
+            return runBatch(options);
+        return run(options);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,227 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include "../include/Distributed.h"
+#include "../include/BitGrid.h"
+#include "../include/MappedFile.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Distributed runner. Either joins a run as one rank (--rank/--size, one
+// process per rank started by a job launcher or by hand on each machine),
+// or with --ranks N forks N local processes that talk over loopback TCP.
+
+struct Options {
+    int localRanks = 0;
+    int rank = -1;
+    int size = 1;
+    std::vector<std::string> hosts;
+    int port = 47000;
+    size_t width = 1024;
+    size_t height = 1024;
+    double density = 0.3;
+    uint64_t seed = 1;
+    int generations = 100;
+    int halo = 1;
+    std::string loadFile;
+    std::string saveFile;
+    WorldFileFormat saveFormat = WorldFileFormat::Binary;
+    std::string chunksFile;
+    bool verify = false;
+};
+
+static void printUsage() {
+    std::cout << "Usage: distributed_life (--ranks N | --rank R --size N [--hosts h0,h1,...]) [--port P]\n"
+              << "                        [--width W] [--height H] [--density D] [--seed S] [--load FILE]\n"
+              << "                        [--generations G] [--halo K] [--save FILE [--format text|binary|rle]]\n"
+              << "                        [--chunks FILE] [--verify]\n";
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--verify") {
+            options.verify = true;
+        } else if (arg == "--ranks" && hasValue) {
+            options.localRanks = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rank" && hasValue) {
+            options.rank = std::atoi(argv[++i]);
+        } else if (arg == "--size" && hasValue) {
+            options.size = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--hosts" && hasValue) {
+            std::istringstream list(argv[++i]);
+            std::string host;
+            while (std::getline(list, host, ','))
+                options.hosts.push_back(host);
+        } else if (arg == "--port" && hasValue) {
+            options.port = std::atoi(argv[++i]);
+        } else if (arg == "--width" && hasValue) {
+            options.width = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--height" && hasValue) {
+            options.height = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--density" && hasValue) {
+            options.density = std::atof(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--generations" && hasValue) {
+            options.generations = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--halo" && hasValue) {
+            options.halo = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--load" && hasValue) {
+            options.loadFile = argv[++i];
+        } else if (arg == "--save" && hasValue) {
+            options.saveFile = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            std::string format = argv[++i];
+            if (format == "text") {
+                options.saveFormat = WorldFileFormat::Text;
+            } else if (format == "rle") {
+                options.saveFormat = WorldFileFormat::BinaryRLE;
+            } else if (format == "binary") {
+                options.saveFormat = WorldFileFormat::Binary;
+            } else {
+                std::cerr << "Unknown format '" << format << "'.\n";
+                return false;
+            }
+        } else if (arg == "--chunks" && hasValue) {
+            options.chunksFile = argv[++i];
+        } else {
+            printUsage();
+            return false;
+        }
+    }
+    if (options.localRanks == 0 && options.rank < 0) {
+        printUsage();
+        return false;
+    }
+    return true;
+}
+
+static int runRank(Options options, int rank, int size) {
+    try {
+        if (!options.loadFile.empty()) {
+            // Every rank needs the dimensions before the world is split
+            MappedFile file;
+            WorldFileHeader header;
+            if (!mapWorldFile(options.loadFile, file, header)) {
+                std::vector<int> cells;
+                header = loadWorldFile(options.loadFile, cells);
+            }
+            options.width = static_cast<size_t>(header.width);
+            options.height = static_cast<size_t>(header.height);
+        }
+
+        Communicator comm(rank, size, options.hosts, options.port);
+        DistributedLife world(comm, options.width, options.height, options.halo);
+        if (options.loadFile.empty())
+            world.randomize(options.density, options.seed);
+        else
+            world.loadFromFile(options.loadFile);
+
+        std::vector<int> initial;
+        if (options.verify)
+            initial = world.gather();
+
+        const BlockDecomposition& blocks = world.getDecomposition();
+        if (rank == 0)
+            std::cout << "World " << options.width << "x" << options.height << " on " << size << " rank(s) as "
+                      << blocks.px << "x" << blocks.py << " blocks, halo depth " << options.halo << "\n";
+
+        comm.barrier();
+        auto start = std::chrono::steady_clock::now();
+        world.evolve(options.generations);
+        comm.barrier();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Mean per-rank split of the run, in microseconds
+        uint64_t exchangeUs = comm.allReduceSum(static_cast<uint64_t>(world.getExchangeSeconds() * 1e6));
+        uint64_t computeUs = comm.allReduceSum(static_cast<uint64_t>(world.getComputeSeconds() * 1e6));
+        uint64_t population = world.population();
+        if (rank == 0) {
+            double cellUpdates = static_cast<double>(options.width) * options.height * options.generations;
+            std::cout << options.generations << " generations in " << seconds << " s ("
+                      << (seconds > 0.0 ? cellUpdates / seconds : 0.0) << " cells/s)\n"
+                      << "Mean per rank: halo exchange " << exchangeUs / 1e6 / size << " s, compute "
+                      << computeUs / 1e6 / size << " s\n"
+                      << "Population: " << population << "\n";
+        }
+
+        int status = 0;
+        if (options.verify) {
+            std::vector<int> finalGrid = world.gather();
+            if (rank == 0) {
+                BitGrid reference(options.width, options.height);
+                reference.pack(initial);
+                reference.evolve(options.generations);
+                std::vector<int> expected;
+                reference.unpack(expected);
+                bool match = (expected == finalGrid);
+                std::cout << "Verification against a single-process run: " << (match ? "passed" : "FAILED") << "\n";
+                status = match ? 0 : 2;
+            }
+        }
+
+        if (!options.saveFile.empty()) {
+            world.saveGathered(options.saveFile, options.saveFormat);
+            if (rank == 0)
+                std::cout << "World saved to '" << options.saveFile << "'.\n";
+        }
+        if (!options.chunksFile.empty()) {
+            world.saveChunks(options.chunksFile);
+            if (rank == 0)
+                std::cout << "Blocks saved to '" << options.chunksFile << ".<rank>', manifest '"
+                          << options.chunksFile << "'.\n";
+        }
+        return status;
+    } catch (const std::exception& e) {
+        std::cerr << "Rank " << rank << ": " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    if (options.rank >= 0)
+        return runRank(options, options.rank, options.size);
+
+#ifdef _WIN32
+    std::cerr << "--ranks needs fork(); start one process per rank with --rank and --size instead.\n";
+    return 1;
+#else
+    std::cout.flush();
+    std::vector<pid_t> children;
+    for (int r = 0; r < options.localRanks; ++r) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int status = runRank(options, r, options.localRanks);
+            std::cout.flush();
+            _exit(status);
+        }
+        if (pid < 0) {
+            std::cerr << "fork() failed.\n";
+            return 1;
+        }
+        children.push_back(pid);
+    }
+
+    int result = 0;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            result = (WIFEXITED(status) && WEXITSTATUS(status) == 2 && result == 0) ? 2 : 1;
+    }
+    return result;
+#endif
+}
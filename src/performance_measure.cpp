@@ -5,50 +5,530 @@
 #include <sstream>
 #include <iomanip>
 #include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
 #include "../include/GameOfLife.h"
+#include "../include/ProgramCache.h"
+#include "../include/SimdLife.h"
 
-int main() {
-    std::vector<std::pair<int, int>> gridSizes = {
-        {10,10}, {20,20}, {100,100}, 
-        {1000,1000}, {10000,10000}
-    };
+// Benchmark harness for every evolution engine. Each (engine, case) pair is
+// run warmup + repetitions times on a freshly seeded world. Setup, host to
+// device transfer, compute and device to host transfer are timed
+// separately (transfers only exist for OpenCL engines), and the final grid
+// is cross-checked against evolveScalar().
+
+struct BenchmarkCase {
+    std::string group;   // "size", "aspect" or "density"
+    size_t width;
+    size_t height;
+    double density;
+    int generations;
+};
+
+struct Engine {
+    std::string name;
+    bool opencl;
+    GameOfLife::KernelVariant variant;
+    size_t maxCells;     // larger cases are skipped (0 = no limit)
+    std::function<void(GameOfLife&, int)> run;
+    GameOfLife::CellStorage storage = GameOfLife::CellStorage::Int;
+    // Timed as setup for engines without the OpenCL phases; false = unavailable
+    std::function<bool(GameOfLife&)> setup = nullptr;
+};
+
+struct Summary {
+    double median = 0.0;
+    double p10 = 0.0;
+    double p90 = 0.0;
+    double min = 0.0;
+};
+
+struct Result {
+    std::string engine;
+    BenchmarkCase benchCase;
+    int repetitions = 0;
+    Summary setup;
+    Summary upload;
+    Summary compute;
+    Summary download;
+    double cellsPerSecond = 0.0;
+    std::string verified;  // "yes", "no" or "skipped"
+};
+
+struct StartupResult {
+    bool measured = false;
+    double coldMs = 0.0;
+    double warmMs = 0.0;
+    bool warmFromCache = false;
+};
+
+struct Options {
+    int repetitions = 5;
+    int warmup = 1;
+    bool quick = false;
+    bool io = true;
+    std::vector<std::string> engines;
+    std::string device;  // OpenCL device selector, see GameOfLife::setOpenCLDevice()
+    Rule rule;
+    std::string jsonFile = "benchmark_results.json";
+    std::string csvFile = "benchmark_results.csv";
+};
+
+static const unsigned benchmarkSeed = 12345;
+
+// Linear interpolation between closest ranks
+static double percentile(std::vector<double> samples, double p) {
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    double rank = p * (samples.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    size_t upper = std::min(lower + 1, samples.size() - 1);
+    double fraction = rank - lower;
+    return samples[lower] + (samples[upper] - samples[lower]) * fraction;
+}
+
+static Summary summarize(const std::vector<double>& samples) {
+    Summary summary;
+    if (samples.empty())
+        return summary;
+    summary.median = percentile(samples, 0.5);
+    summary.p10 = percentile(samples, 0.1);
+    summary.p90 = percentile(samples, 0.9);
+    summary.min = *std::min_element(samples.begin(), samples.end());
+    return summary;
+}
 
-    std::ofstream csvFile("simulation_results.csv");
-    csvFile << "Width,Height,Generations,Elapsed Time (s)\n";
-
-    for (const auto& grid : gridSizes) {
-        int width = grid.first;
-        int height = grid.second;
-        int generations = 100; 
-        
-        std::cout << "Testing " << width << "x" << height << " grid with OpenCL...\n";
-        
-        try {
-            GameOfLife world(width, height);
-            world.randomize(0.3);
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void seedWorld(GameOfLife& world, double density) {
+    world.randomize(density, benchmarkSeed);
+}
+
+// Keeps total work per repetition roughly constant across grid sizes
+static int generationsFor(size_t cells) {
+    const double cellUpdates = 5e7;
+    int generations = static_cast<int>(cellUpdates / static_cast<double>(cells));
+    return std::max(4, std::min(100, generations));
+}
+
+static std::vector<BenchmarkCase> buildCases(bool quick) {
+    std::vector<BenchmarkCase> cases;
+    std::vector<size_t> squareSizes = quick ? std::vector<size_t>{ 64, 512 }
+                                            : std::vector<size_t>{ 64, 256, 1024, 4096 };
+    for (size_t size : squareSizes)
+        cases.push_back({ "size", size, size, 0.3, generationsFor(size * size) });
+
+    std::vector<std::pair<size_t, size_t>> aspects = quick
+        ? std::vector<std::pair<size_t, size_t>>{ { 2048, 128 }, { 128, 2048 } }
+        : std::vector<std::pair<size_t, size_t>>{ { 4096, 256 }, { 256, 4096 }, { 16384, 64 }, { 1000, 1000 } };
+    for (const auto& aspect : aspects)
+        cases.push_back({ "aspect", aspect.first, aspect.second, 0.3, generationsFor(aspect.first * aspect.second) });
+
+    size_t densitySize = quick ? 256 : 1024;
+    for (double density : { 0.05, 0.15, 0.5 })
+        cases.push_back({ "density", densitySize, densitySize, density, generationsFor(densitySize * densitySize) });
+    return cases;
+}
+
+static std::vector<Engine> buildEngines() {
+    std::vector<Engine> engines;
+    engines.push_back({ "scalar", false, GameOfLife::KernelVariant::Naive, 0,
+                        [](GameOfLife& world, int generations) {
+                            for (int g = 0; g < generations; ++g)
+                                world.evolveScalar();
+                        } });
+    // The best instruction set, then each one for comparison; those the
+    // CPU lacks are reported as unavailable
+    engines.push_back({ "simd", false, GameOfLife::KernelVariant::Naive, 0,
+                        [](GameOfLife& world, int generations) { world.evolveSimd(generations); } });
+    for (SimdIsa isa : { SimdIsa::Scalar, SimdIsa::AVX2, SimdIsa::AVX512, SimdIsa::Neon }) {
+        engines.push_back({ std::string("simd-") + SimdLife::isaName(isa), false, GameOfLife::KernelVariant::Naive, 0,
+                            [](GameOfLife& world, int generations) { world.evolveSimd(generations); },
+                            GameOfLife::CellStorage::Int,
+                            [isa](GameOfLife& world) {
+                                world.setSimdIsa(isa);
+                                return SimdLife::isSupported(isa);
+                            } });
+    }
+    engines.push_back({ "threaded", false, GameOfLife::KernelVariant::Naive, 0,
+                        [](GameOfLife& world, int generations) { world.evolveThreaded(generations); } });
+    engines.push_back({ "bitpacked", false, GameOfLife::KernelVariant::Naive, 0,
+                        [](GameOfLife& world, int generations) { world.evolveBitPacked(generations); } });
+    engines.push_back({ "sparse", false, GameOfLife::KernelVariant::Naive, 0,
+                        [](GameOfLife& world, int generations) { world.evolveSparse(generations); } });
+    // Random soups are HashLife's worst case; keep it to sizes it handles in seconds
+    engines.push_back({ "hashlife", false, GameOfLife::KernelVariant::Naive, size_t(1) << 18,
+                        [](GameOfLife& world, int generations) {
+                            world.evolveHashLife(static_cast<uint64_t>(generations));
+                        } });
+    engines.push_back({ "opencl-naive", true, GameOfLife::KernelVariant::Naive, 0, nullptr });
+    engines.push_back({ "opencl-tiled", true, GameOfLife::KernelVariant::Tiled, 0, nullptr });
+    engines.push_back({ "opencl-blocked", true, GameOfLife::KernelVariant::TemporalBlocked, 0, nullptr });
+    engines.push_back({ "opencl-naive-uchar", true, GameOfLife::KernelVariant::Naive, 0, nullptr,
+                        GameOfLife::CellStorage::UChar });
+    engines.push_back({ "opencl-tiled-uchar", true, GameOfLife::KernelVariant::Tiled, 0, nullptr,
+                        GameOfLife::CellStorage::UChar });
+    engines.push_back({ "opencl-bitpacked", true, GameOfLife::KernelVariant::Naive, 0, nullptr,
+                        GameOfLife::CellStorage::BitPacked });
+    // Strips over every device; each call uploads and downloads the grid
+    engines.push_back({ "opencl-multi", false, GameOfLife::KernelVariant::Naive, 0,
+                        [](GameOfLife& world, int generations) { world.evolveMultiDevice(generations); },
+                        GameOfLife::CellStorage::Int,
+                        [](GameOfLife& world) { return world.evolveMultiDevice(0); } });
+    // The same with every device split into four sub-devices, so a single
+    // CPU device still runs (and is checked with) several strips and their
+    // halo exchanges
+    engines.push_back({ "opencl-multi-sub4", false, GameOfLife::KernelVariant::Naive, 0,
+                        [](GameOfLife& world, int generations) {
+                            world.evolveMultiDevice(generations, std::string(), 4);
+                        },
+                        GameOfLife::CellStorage::Int,
+                        [](GameOfLife& world) { return world.evolveMultiDevice(0, std::string(), 4); } });
+    return engines;
+}
+
+// Returns false if the engine is unavailable (e.g. no OpenCL device)
+static bool runBenchmark(const Engine& engine, const BenchmarkCase& benchCase, const Options& options,
+                         const std::vector<int>& reference, Result& result) {
+    std::vector<double> setupTimes, uploadTimes, computeTimes, downloadTimes;
+    std::vector<int> finalGrid;
+
+    for (int rep = -options.warmup; rep < options.repetitions; ++rep) {
+        GameOfLife world(benchCase.width, benchCase.height);
+        seedWorld(world, benchCase.density);
+        world.setRule(options.rule);
+
+        double setup = 0.0, upload = 0.0, compute = 0.0, download = 0.0;
+        if (engine.opencl) {
+            world.setOpenCLDevice(options.device);
+            world.setKernelVariant(engine.variant);
+            world.setCellStorage(engine.storage);
+
+            // The first zero-generation call builds the program and uploads
+            // the grid; rewriting a cell forces a second, upload-only call
             auto start = std::chrono::steady_clock::now();
-            bool success = world.evolveOpenCL(generations);
-            if (!success) {
-                std::cerr << "OpenCL evolution failed for " << width << "x" << height << " grid\n";
+            if (!world.evolveOpenCL(0))
+                return false;
+            double setupAndUpload = secondsSince(start);
+
+            world.setCellState(0, 0, world.getCellState(0, 0));
+            start = std::chrono::steady_clock::now();
+            if (!world.evolveOpenCL(0))
+                return false;
+            upload = secondsSince(start);
+            setup = std::max(0.0, setupAndUpload - upload);
+
+            start = std::chrono::steady_clock::now();
+            if (!world.evolveOpenCL(benchCase.generations))
+                return false;
+            compute = secondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            world.getCurrentGrid();
+            download = secondsSince(start);
+        } else {
+            if (engine.setup) {
+                auto start = std::chrono::steady_clock::now();
+                if (!engine.setup(world))
+                    return false;
+                setup = secondsSince(start);
+            }
+            auto start = std::chrono::steady_clock::now();
+            engine.run(world, benchCase.generations);
+            compute = secondsSince(start);
+        }
+
+        if (rep < 0)
+            continue;
+        setupTimes.push_back(setup);
+        uploadTimes.push_back(upload);
+        computeTimes.push_back(compute);
+        downloadTimes.push_back(download);
+        if (rep == options.repetitions - 1)
+            finalGrid = world.getCurrentGrid();
+    }
+
+    result.engine = engine.name;
+    result.benchCase = benchCase;
+    result.repetitions = options.repetitions;
+    result.setup = summarize(setupTimes);
+    result.upload = summarize(uploadTimes);
+    result.compute = summarize(computeTimes);
+    result.download = summarize(downloadTimes);
+    double cellUpdates = static_cast<double>(benchCase.width) * benchCase.height * benchCase.generations;
+    result.cellsPerSecond = result.compute.median > 0.0 ? cellUpdates / result.compute.median : 0.0;
+    if (reference.empty())
+        result.verified = "skipped";
+    else
+        result.verified = (finalGrid == reference) ? "yes" : "no";
+    return true;
+}
+
+static void writeCsv(const std::string& filename, const std::vector<Result>& results) {
+    std::ofstream csv(filename);
+    csv << "Engine,Group,Width,Height,Density,Generations,Repetitions,"
+           "Setup (s),Upload (s),Compute Median (s),Compute P10 (s),Compute P90 (s),Compute Min (s),"
+           "Download (s),Cells/s,Verified\n";
+    csv << std::setprecision(6);
+    for (const Result& r : results) {
+        csv << r.engine << "," << r.benchCase.group << ","
+            << r.benchCase.width << "," << r.benchCase.height << ","
+            << r.benchCase.density << "," << r.benchCase.generations << "," << r.repetitions << ","
+            << std::fixed << r.setup.median << "," << r.upload.median << ","
+            << r.compute.median << "," << r.compute.p10 << "," << r.compute.p90 << "," << r.compute.min << ","
+            << r.download.median << ","
+            << std::scientific << r.cellsPerSecond << std::defaultfloat << ","
+            << r.verified << "\n";
+    }
+}
+
+static void writeSummaryJson(std::ostream& out, const char* name, const Summary& summary) {
+    out << "\"" << name << "\": {\"median\": " << summary.median << ", \"p10\": " << summary.p10
+        << ", \"p90\": " << summary.p90 << ", \"min\": " << summary.min << "}";
+}
+
+static void writeJson(const std::string& filename, const std::vector<Result>& results, const Options& options,
+                      const StartupResult& startup) {
+    std::ofstream json(filename);
+    json << std::setprecision(9);
+    json << "{\n  \"repetitions\": " << options.repetitions << ",\n  \"warmup\": " << options.warmup
+         << ",\n  \"seed\": " << benchmarkSeed << ",\n  \"rule\": \"" << ruleToString(options.rule) << "\",\n";
+    if (startup.measured)
+        json << "  \"opencl_startup\": {\"cold_ms\": " << startup.coldMs << ", \"warm_ms\": " << startup.warmMs
+             << ", \"warm_from_cache\": " << (startup.warmFromCache ? "true" : "false") << "},\n";
+    json << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        json << "    {\"engine\": \"" << r.engine << "\", \"group\": \"" << r.benchCase.group
+             << "\", \"width\": " << r.benchCase.width << ", \"height\": " << r.benchCase.height
+             << ", \"density\": " << r.benchCase.density << ", \"generations\": " << r.benchCase.generations
+             << ",\n     ";
+        writeSummaryJson(json, "setup", r.setup);
+        json << ", ";
+        writeSummaryJson(json, "upload", r.upload);
+        json << ",\n     ";
+        writeSummaryJson(json, "compute", r.compute);
+        json << ", ";
+        writeSummaryJson(json, "download", r.download);
+        json << ",\n     \"cells_per_second\": " << r.cellsPerSecond << ", \"verified\": \"" << r.verified << "\"}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+}
+
+// OpenCL initialization with an empty program cache, then with the binary
+// the first run stored. Uses its own cache directory and removes it after.
+static StartupResult measureStartup(const std::string& device) {
+    StartupResult startup;
+    const char* cacheDir = "performance_measure_kernel_cache";
+    std::error_code error;
+    std::filesystem::remove_all(cacheDir, error);
+    setProgramCacheDirectory(cacheDir);
+
+    for (int run = 0; run < 2; ++run) {
+        GameOfLife world(64, 64);
+        world.setOpenCLDevice(device);
+        if (!world.evolveOpenCL(0))
+            break;
+        const GameOfLife::OpenCLStartup& info = world.getOpenCLStartup();
+        if (run == 0) {
+            startup.coldMs = info.initMs;
+        } else {
+            startup.warmMs = info.initMs;
+            startup.warmFromCache = info.programFromCache;
+            startup.measured = true;
+        }
+    }
+
+    setProgramCacheDirectory("");
+    std::filesystem::remove_all(cacheDir, error);
+    return startup;
+}
+
+static void measureFileIO(const std::vector<BenchmarkCase>& cases) {
+    std::vector<std::pair<const char*, WorldFileFormat>> formats = {
+        {"text", WorldFileFormat::Text},
+        {"binary", WorldFileFormat::Binary},
+        {"rle", WorldFileFormat::BinaryRLE}
+    };
+    const char* ioFilename = "performance_measure_world.tmp";
+
+    std::ofstream ioCsvFile("io_results.csv");
+    ioCsvFile << "Format,Width,Height,File Size (bytes),Save Time (s),Load Time (s),Save (Mcells/s),Load (Mcells/s)\n";
+
+    for (const auto& format : formats) {
+        for (const BenchmarkCase& benchCase : cases) {
+            if (benchCase.group != "size")
+                continue;
+            size_t width = benchCase.width;
+            size_t height = benchCase.height;
+            double cells = static_cast<double>(width) * height;
+
+            std::cout << "Saving and loading " << width << "x" << height << " grid ("
+                      << format.first << " format)...\n";
+
+            try {
+                GameOfLife world(width, height);
+                seedWorld(world, benchCase.density);
+
+                auto start = std::chrono::steady_clock::now();
+                world.saveToFile(ioFilename, format.second);
+                double saveTime = secondsSince(start);
+                start = std::chrono::steady_clock::now();
+                GameOfLife loaded(ioFilename);
+                double loadTime = secondsSince(start);
+
+                if (loaded.getCurrentGrid() != world.getCurrentGrid()) {
+                    std::cerr << "Loaded world differs from the saved one for " << width << "x" << height << " grid\n";
+                    continue;
+                }
+
+                std::ifstream sizeProbe(ioFilename, std::ios::binary | std::ios::ate);
+                long long fileSize = static_cast<long long>(sizeProbe.tellg());
+
+                ioCsvFile << format.first << ","
+                          << width << "," << height << ","
+                          << fileSize << ","
+                          << std::fixed << std::setprecision(6)
+                          << saveTime << "," << loadTime << ","
+                          << cells / saveTime / 1e6 << "," << cells / loadTime / 1e6 << "\n";
+
+                std::cout << "Save: " << saveTime << "s, load: " << loadTime << "s, "
+                          << fileSize << " bytes\n";
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+        }
+    }
+
+    std::remove(ioFilename);
+    std::cout << "Results saved to io_results.csv\n";
+}
+
+static void printUsage() {
+    std::cout << "Usage: performance_measure [--quick] [--reps N] [--warmup N] [--engines a,b,...]\n"
+              << "                           [--device SEL] [--rule RULE] [--json FILE] [--csv FILE] [--no-io]\n"
+              << "Engines: scalar, simd, simd-scalar, simd-avx2, simd-avx512, simd-neon, threaded, bitpacked, sparse,\n"
+              << "         hashlife, opencl-naive, opencl-tiled, opencl-blocked,\n"
+              << "         opencl-naive-uchar, opencl-tiled-uchar, opencl-bitpacked, opencl-multi,\n"
+              << "         opencl-multi-sub4\n";
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--no-io") {
+            options.io = false;
+        } else if (arg == "--reps" && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && hasValue) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--rule" && hasValue) {
+            try {
+                options.rule = parseRule(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return false;
+            }
+        } else if (arg == "--device" && hasValue) {
+            options.device = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonFile = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            options.csvFile = argv[++i];
+        } else if (arg == "--engines" && hasValue) {
+            std::istringstream list(argv[++i]);
+            std::string name;
+            while (std::getline(list, name, ','))
+                options.engines.push_back(name);
+        } else {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    std::vector<BenchmarkCase> cases = buildCases(options.quick);
+    std::vector<Engine> engines = buildEngines();
+    std::vector<Result> results;
+    std::vector<std::string> unavailable;
+
+    StartupResult startup;
+    bool anyOpenCL = std::any_of(engines.begin(), engines.end(), [&](const Engine& engine) {
+        return engine.opencl && (options.engines.empty()
+            || std::find(options.engines.begin(), options.engines.end(), engine.name) != options.engines.end());
+    });
+    if (anyOpenCL) {
+        startup = measureStartup(options.device);
+        if (startup.measured)
+            std::cout << "OpenCL initialization: " << startup.coldMs << " ms cold, " << startup.warmMs << " ms warm ("
+                      << (startup.warmFromCache ? "program binary cache hit" : "program binary cache miss") << ")\n";
+    }
+
+    for (const BenchmarkCase& benchCase : cases) {
+        // Reference for the cross-check: the scalar engine on the same seed
+        std::cout << "Case " << benchCase.group << " " << benchCase.width << "x" << benchCase.height
+                  << ", density " << benchCase.density << ", " << benchCase.generations << " generations\n";
+        GameOfLife referenceWorld(benchCase.width, benchCase.height);
+        seedWorld(referenceWorld, benchCase.density);
+        referenceWorld.setRule(options.rule);
+        for (int g = 0; g < benchCase.generations; ++g)
+            referenceWorld.evolveScalar();
+        const std::vector<int> reference = referenceWorld.getCurrentGrid();
+
+        for (const Engine& engine : engines) {
+            if (!options.engines.empty()
+                && std::find(options.engines.begin(), options.engines.end(), engine.name) == options.engines.end())
+                continue;
+            if (std::find(unavailable.begin(), unavailable.end(), engine.name) != unavailable.end())
+                continue;
+            if (engine.maxCells != 0 && benchCase.width * benchCase.height > engine.maxCells)
+                continue;
+
+            Result result;
+            if (!runBenchmark(engine, benchCase, options, reference, result)) {
+                std::cerr << "Engine " << engine.name << " is unavailable; skipping it.\n";
+                unavailable.push_back(engine.name);
                 continue;
             }
-            
-            auto end = std::chrono::steady_clock::now();
-            auto duration = std::chrono::duration<double>(end - start);
-            
-            csvFile << width << "," << height << "," 
-                   << generations << "," 
-                   << std::fixed << std::setprecision(6) 
-                   << duration.count() << "\n";
-            
-            std::cout << "Time: " << duration.count() << "s\n";
-            
-        } catch (const std::exception& e) {
-            std::cerr << "Error: " << e.what() << "\n";
+            std::cout << "  " << std::left << std::setw(19) << engine.name << std::right
+                      << std::scientific << std::setprecision(3) << result.cellsPerSecond << " cells/s"
+                      << std::fixed << std::setprecision(6)
+                      << "  compute median " << result.compute.median << "s (p10 " << result.compute.p10
+                      << ", p90 " << result.compute.p90 << ")";
+            if (result.setup.median > 0.0 || result.upload.median > 0.0)
+                std::cout << ", setup " << result.setup.median << "s, upload " << result.upload.median
+                          << "s, download " << result.download.median << "s";
+            std::cout << std::defaultfloat << "  verified: " << result.verified << "\n";
+            if (result.verified == "no")
+                std::cerr << "Engine " << engine.name << " disagrees with the scalar engine!\n";
+            results.push_back(result);
         }
     }
-    
-    csvFile.close();
-    std::cout << "Results saved to simulation_results.csv\n";
-    return 0;
+
+    writeCsv(options.csvFile, results);
+    writeJson(options.jsonFile, results, options, startup);
+    std::cout << "Results saved to " << options.csvFile << " and " << options.jsonFile << "\n";
+
+    if (options.io)
+        measureFileIO(cases);
+
+    bool allVerified = std::none_of(results.begin(), results.end(),
+                                    [](const Result& r) { return r.verified == "no"; });
+    return allVerified ? 0 : 2;
 }